@@ -0,0 +1,178 @@
+/*
+ * scrm is an implementation of the Sequential-Coalescent-with-Recombination Model.
+ *
+ * Copyright (C) 2013, 2014 Paul R. Staab, Sha (Joe) Zhu, Dirk Metzler and Gerton Lunter
+ *
+ * This file is part of scrm.
+ *
+ * scrm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+/*
+ * bench.cc
+ *
+ * Benchmark suite for scrm, run with 'make bench'. Each scenario is a fixed
+ * command line with a fixed seed that is simulated in a child process, such
+ * that the peak memory usage can be measured for every scenario on its own.
+ * The child runs the simulation loop of the scrm binary from simulate.h,
+ * including -threads, -streams and -rng and the output of the statistics.
+ * The output of the simulations is written to /dev/null. For each scenario,
+ * the wall time, the peak resident set size, the number of simulated
+ * segments (genealogies of a part of a locus) per second and the largest
+ * number of nodes in the ARG are reported in JSON format, together with the
+ * size of a node in the layout scrm was configured with.
+ *
+ * Usage: scrm_bench [scenario ...]
+ * Without arguments, all scenarios are run.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <sys/resource.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "../src/param.h"
+#include "../src/simulate.h"
+
+struct Scenario {
+  const char* name;
+  const char* args;
+};
+
+const Scenario scenarios[] = {
+  { "large_sample", "5000 10 -t 10 -seed 1" },
+  { "chromosome", "50 1 -t 20000 -r 20000 100000000 -l 100000 -seed 2" },
+  { "migration", "30 500 -t 10 -r 10 100000 -I 3 10 10 10 -M 1 "
+                 "-ej 0.5 2 1 -ej 1.5 3 1 -seed 3" },
+  { "growth", "100 500 -t 10 -r 10 100000 -G 5 -eG 0.5 0 -seed 4" },
+  { "ancient_samples", "40 500 -t 10 -r 10 100000 -I 2 20 0 1 "
+                       "-eI 0.2 0 20 -ej 1.0 2 1 -seed 5" },
+  { "output_trees", "50 200 -r 20 100000 -T -seed 6" },
+  { "output_oriented_forest", "50 200 -r 20 100000 -O -seed 7" },
+  { "output_sfs", "50 500 -t 20 -r 20 100000 -oSFS -seed 8" },
+  { "threads", "50 2000 -t 10 -r 10 100000 -threads 4 -rng xoshiro -seed 9" }
+};
+
+
+// Simulates the scenario with the same code that the scrm binary runs.
+SimulationSummary simulateScenario(const Scenario &scenario) {
+  Param user_para(scenario.args);
+  Model model = user_para.parse();
+  std::ofstream stream("/dev/null");
+  return simulate(user_para, model, stream);
+}
+
+
+// Runs the scenario in a child process and prints its results as JSON object.
+bool run(const Scenario &scenario, bool first) {
+  int fds[2];
+  if (pipe(fds) != 0) {
+    perror("pipe");
+    return false;
+  }
+
+  fflush(stdout);
+  auto start = std::chrono::steady_clock::now();
+  pid_t pid = fork();
+  if (pid < 0) {
+    perror("fork");
+    return false;
+  }
+
+  if (pid == 0) {
+    close(fds[0]);
+    SimulationSummary result;
+    try {
+      result = simulateScenario(scenario);
+    } catch (const std::exception &e) {
+      std::cerr << "Error in scenario " << scenario.name << ": " << e.what() << std::endl;
+      _exit(EXIT_FAILURE);
+    }
+    if (write(fds[1], &result, sizeof(result)) != sizeof(result)) _exit(EXIT_FAILURE);
+    _exit(EXIT_SUCCESS);
+  }
+
+  close(fds[1]);
+  SimulationSummary result = { 0, 0 };
+  bool received = (read(fds[0], &result, sizeof(result)) == sizeof(result));
+  close(fds[0]);
+
+  int status;
+  struct rusage usage;
+  if (wait4(pid, &status, 0, &usage) != pid) {
+    perror("wait4");
+    return false;
+  }
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  if (!received || !WIFEXITED(status) || WEXITSTATUS(status) != EXIT_SUCCESS) return false;
+
+  // ru_maxrss is given in kilobytes on Linux, but in bytes on Mac OS.
+#ifdef __APPLE__
+  long max_rss_kb = usage.ru_maxrss / 1024;
+#else
+  long max_rss_kb = usage.ru_maxrss;
+#endif
+
+  printf("%s    {\"name\": \"%s\", \"args\": \"%s\", \"wall_seconds\": %.3f, "
+         "\"max_rss_kb\": %ld, \"segments\": %zu, \"segments_per_second\": %.1f, "
+         "\"max_nodes\": %zu}",
+         first ? "" : ",\n", scenario.name, scenario.args, seconds, max_rss_kb,
+         result.segments, result.segments / seconds, result.max_nodes);
+  fflush(stdout);
+  return true;
+}
+
+
+int main(int argc, char *argv[]) {
+  std::vector<const Scenario*> selected;
+  for (const Scenario &scenario : scenarios) {
+    if (argc == 1) selected.push_back(&scenario);
+  }
+  for (int i = 1; i < argc; ++i) {
+    size_t number = selected.size();
+    for (const Scenario &scenario : scenarios) {
+      if (strcmp(argv[i], scenario.name) == 0) selected.push_back(&scenario);
+    }
+    if (selected.size() == number) {
+      fprintf(stderr, "Unknown scenario '%s'. Available scenarios are:\n", argv[i]);
+      for (const Scenario &scenario : scenarios) fprintf(stderr, "  %s\n", scenario.name);
+      return EXIT_FAILURE;
+    }
+  }
+
+  bool success = true, first = true;
+  printf("{\n  \"version\": \"%s\",\n  \"node_bytes\": %zu,\n  \"nodes_per_mb\": %zu,\n"
+         "  \"scenarios\": [\n", VERSION, sizeof(Node), (size_t)(1 << 20) / sizeof(Node));
+  for (const Scenario* scenario : selected) {
+    if (run(*scenario, first)) {
+      first = false;
+    } else {
+      fprintf(stderr, "Scenario %s failed.\n", scenario->name);
+      success = false;
+    }
+  }
+  printf("\n  ]\n}\n");
+
+  return success ? EXIT_SUCCESS : EXIT_FAILURE;
+}
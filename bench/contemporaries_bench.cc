@@ -0,0 +1,98 @@
+/*
+ * scrm is an implementation of the Sequential-Coalescent-with-Recombination Model.
+ *
+ * Copyright (C) 2013, 2014 Paul R. Staab, Sha (Joe) Zhu, Dirk Metzler and Gerton Lunter
+ *
+ * This file is part of scrm.
+ *
+ * scrm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+/*
+ * contemporaries_bench.cc
+ *
+ * Microbenchmark for the storage backends of the ContemporariesContainer.
+ * Each step mimics a coalescence: two contemporaries are sampled and removed,
+ * and two nodes are added again. Besides the two backends of the container,
+ * a vector that removes nodes using std::find and erase is included as
+ * reference.
+ */
+
+#include <cstdio>
+#include <ctime>
+#include <vector>
+#include <algorithm>
+
+#include "../src/contemporaries_container.h"
+#include "../src/node_container.h"
+#include "../src/random/mersenne_twister.h"
+
+// Vector storage with linear time removal, as used in scrm up to 1.7.4
+class LinearContemporaries {
+ public:
+  LinearContemporaries(size_t, size_t sample_number, RandomGenerator* rg) : rg_(rg) {
+    nodes_.reserve(sample_number + 200);
+  }
+  void add(Node* node) { nodes_.push_back(node); }
+  void remove(Node* node) {
+    auto it = std::find(nodes_.begin(), nodes_.end(), node);
+    if (it != nodes_.end()) nodes_.erase(it);
+  }
+  Node* sample(size_t) const { return nodes_.at(rg_->sampleInt(nodes_.size())); }
+
+ private:
+  std::vector<Node*> nodes_;
+  RandomGenerator* rg_;
+};
+
+template <class Container>
+double benchmark(Container &cc, const std::vector<Node*> &nodes, const size_t steps) {
+  for (Node* node : nodes) cc.add(node);
+
+  clock_t start = clock();
+  for (size_t i = 0; i < steps; ++i) {
+    Node* a = cc.sample(0);
+    cc.remove(a);
+    Node* b = cc.sample(0);
+    cc.remove(b);
+    cc.add(b);
+    cc.add(a);
+  }
+  double seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+  return seconds * 1e9 / steps;
+}
+
+int main() {
+  const size_t sizes[] = {100, 1000, 10000, 100000};
+  MersenneTwister rg(1);
+
+  printf("Samples\tBackend\t\tns/step\n");
+  for (size_t n : sizes) {
+    NodeContainer nc;
+    std::vector<Node*> nodes;
+    for (size_t i = 0; i < n; ++i) nodes.push_back(nc.createNode(0, i+1));
+    const size_t steps = std::max((size_t)1000, (size_t)100000000 / n);
+
+    LinearContemporaries lc(1, n, &rg);
+    printf("%zu\tvector-find\t%.1f\n", n, benchmark(lc, nodes, steps));
+
+    ContemporariesContainer set_cc(1, n, &rg, true);
+    printf("%zu\tset\t\t%.1f\n", n, benchmark(set_cc, nodes, steps));
+
+    ContemporariesContainer vec_cc(1, n, &rg);
+    printf("%zu\tindexed-vector\t%.1f\n", n, benchmark(vec_cc, nodes, steps));
+  }
+  return 0;
+}
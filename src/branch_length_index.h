@@ -0,0 +1,127 @@
+/*
+ * scrm is an implementation of the Sequential-Coalescent-with-Recombination Model.
+ *
+ * Copyright (C) 2013, 2014 Paul R. Staab, Sha (Joe) Zhu, Dirk Metzler and Gerton Lunter
+ *
+ * This file is part of scrm.
+ *
+ * scrm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+/*!
+ * \file branch_length_index.h
+ * \brief A segment tree over the lengths of the local branches.
+ *
+ * The Forest stores the length of the local branch above each node at the
+ * node's slot in the NodeContainer, and zero for all other slots. The sums
+ * over the slots allow to find the branch on which a point of the local tree
+ * lies in O(log n) steps, independent of the shape of the tree.
+ */
+
+#ifndef scrm_src_branch_length_index
+#define scrm_src_branch_length_index
+
+#include "macros.h" // Needs to be before cassert
+
+#include <vector>
+#include <cassert>
+#include <cmath>
+#include <algorithm>
+
+class BranchLengthIndex {
+ public:
+  BranchLengthIndex() : leaves_(0), used_(0) { };
+
+  // Sets the length stored for a slot and updates the sums above it.
+  void set(const size_t slot, const double length) {
+    assert( length >= 0 );
+    if (slot >= leaves_) {
+      if (length == 0.0) return;
+      grow(slot);
+    }
+
+    size_t pos = leaves_ + slot;
+    if (sums_[pos] == length) return;
+    sums_[pos] = length;
+    used_ = std::max(used_, slot + 1);
+    for (pos /= 2; pos > 0; pos /= 2) sums_[pos] = sums_[2*pos] + sums_[2*pos+1];
+  }
+
+  double get(const size_t slot) const {
+    if (slot >= leaves_) return 0.0;
+    return sums_[leaves_ + slot];
+  }
+
+  double total() const {
+    if (leaves_ == 0) return 0.0;
+    return sums_[1];
+  }
+
+  /**
+   * @brief Finds the slot of the branch that contains the point at 'length'
+   * when the branches are laid out in the order of their slots.
+   *
+   * @param length The position of the point, between 0 and total(). Is set to
+   *               the position of the point on the branch that is returned.
+   * @return The slot of the branch.
+   */
+  size_t find(double &length) const {
+    assert( total() > 0.0 );
+    size_t pos = 1;
+    while (pos < leaves_) {
+      pos *= 2;
+      // Only descend into parts that contain a branch, also when rounding
+      // errors place the point behind the last one.
+      if (sums_[pos] == 0.0 || (length >= sums_[pos] && sums_[pos+1] > 0.0)) {
+        length -= sums_[pos];
+        ++pos;
+      }
+    }
+    assert( sums_[pos] > 0.0 );
+    length = std::max(0.0, std::min(length, std::nextafter(sums_[pos], 0.0)));
+    return pos - leaves_;
+  }
+
+  // Resets the slots that were used since the last call, and the sums above
+  // them, level by level.
+  void clear() {
+    for (size_t first = leaves_, last = leaves_ + used_; first > 0;
+         first /= 2, last = (last + 1) / 2) {
+      std::fill(sums_.begin() + first, sums_.begin() + last, 0.0);
+    }
+    used_ = 0;
+  }
+
+ private:
+  // Doubles the number of slots until 'slot' fits in.
+  void grow(const size_t slot) {
+    size_t leaves = std::max(leaves_, (size_t)256);
+    while (leaves <= slot) leaves *= 2;
+
+    std::vector<double> sums(2 * leaves, 0.0);
+    for (size_t i = 0; i < leaves_; ++i) sums[leaves + i] = sums_[leaves_ + i];
+    for (size_t pos = leaves - 1; pos > 0; --pos) sums[pos] = sums[2*pos] + sums[2*pos+1];
+
+    sums_.swap(sums);
+    leaves_ = leaves;
+  }
+
+  size_t leaves_;             // The number of slots, a power of two
+  size_t used_;               // All slots from here on are zero
+  std::vector<double> sums_;  // The lengths of the slots at [leaves_, 2*leaves_),
+                              // and at pos the sum of the entries 2*pos and 2*pos+1
+};
+
+#endif
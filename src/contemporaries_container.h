@@ -104,7 +104,8 @@ class ContemporariesContainer {
   ContemporariesContainer();
   ContemporariesContainer(const size_t pop_number,
                           const size_t sample_number,
-                          RandomGenerator *rg);
+                          RandomGenerator *rg,
+                          const bool use_set = false);
   ~ContemporariesContainer(){};
 
   void add(Node* node);
@@ -207,16 +208,18 @@ inline ContemporariesContainer::ContemporariesContainer() {
 
 inline ContemporariesContainer::ContemporariesContainer(const size_t pop_number,
                                                         const size_t sample_number,
-                                                        RandomGenerator* rg) {
-
-  // Use vectors for the storage if the number of samples is below 750.
-  // This threshold is mostly arbitrary, with simulation supporting it in
-  // special situations.
-  if (sample_number <= 750) {
+                                                        RandomGenerator* rg,
+                                                        const bool use_set) {
+
+  // By default, store the contemporaries in vectors. As each node knows its
+  // position in the vector, adding, removing and sampling nodes are all
+  // possible in constant time. The set-based storage needs linear time for
+  // sampling and is only kept for comparison.
+  if (!use_set) {
     contemporaries_vec1_ = std::vector<std::vector<Node*> >(pop_number);
-    for ( auto it : contemporaries_vec1_ ) it.reserve(sample_number + 200);
+    for ( auto &it : contemporaries_vec1_ ) it.reserve(sample_number + 200);
     contemporaries_vec2_ = std::vector<std::vector<Node*> >(pop_number);
-    for ( auto it : contemporaries_vec2_ ) it.reserve(sample_number + 200);
+    for ( auto &it : contemporaries_vec2_ ) it.reserve(sample_number + 200);
     use_set_ = false;
   } else {
     size_t bucket_nr = std::ceil((sample_number + 200) * 1.4);
@@ -233,20 +236,29 @@ inline void ContemporariesContainer::add(Node* node) {
   assert(node != NULL);
   assert(!node->is_root());
   if (use_set_) contemporaries_set().at(node->population()).insert(node);
-  else contemporaries_vector().at(node->population()).push_back(node);
+  else {
+    std::vector<Node*> &contemporaries = contemporaries_vector().at(node->population());
+    node->contemporaries_index_ = contemporaries.size();
+    contemporaries.push_back(node);
+  }
 }
 
+// In vector mode, each node remembers its position in the vector of its
+// population, so that it can be removed by swapping it with the last node.
+// A node can also be in the buffer at a different position, so we need to
+// check if the position belongs to the current contemporaries.
 inline void ContemporariesContainer::remove(Node* node) {
   assert(node != NULL);
   if (use_set_) contemporaries_set().at(node->population()).erase(node);
   else {
-    size_t pop = node->population();
-    auto it = std::find(contemporaries_vector().at(pop).begin(),
-                        contemporaries_vector().at(pop).end(),
-                        node);
-    if (it != contemporaries_vector().at(pop).end()) {
-      contemporaries_vector().at(pop).erase(it);
+    std::vector<Node*> &contemporaries = contemporaries_vector().at(node->population());
+    size_t idx = node->contemporaries_index_;
+    if (idx < contemporaries.size() && contemporaries[idx] == node) {
+      contemporaries[idx] = contemporaries.back();
+      contemporaries[idx]->contemporaries_index_ = idx;
+      contemporaries.pop_back();
     }
+    assert( std::find(contemporaries.begin(), contemporaries.end(), node) == contemporaries.end() );
   }
 }
 
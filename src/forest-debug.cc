@@ -84,6 +84,9 @@ void Forest::createExampleTree() {
   this->tmp_event_time_ = -1; 
   this->coalescence_finished_ = true;
 
+  // The nodes were linked without updating the index of local branches
+  for (auto it = nodes()->iterator(); it.good(); ++it) updateBranchLength(*it);
+
   assert( this->checkTreeLength() );
   assert( this->checkTree() );
 }
@@ -159,6 +162,30 @@ bool Forest::checkTreeLength() const {
 }
 
 
+bool Forest::checkBranchLengths() const {
+  double total = 0.0;
+  for (ConstNodeIterator it = getNodes()->iterator(); it.good(); ++it) {
+    double length = (*it)->local() ? (*it)->height_above() : 0.0;
+    if ( branch_lengths_.get(getNodes()->slot(*it)) != length ) {
+      dout << "Error: Branch length index stores "
+           << branch_lengths_.get(getNodes()->slot(*it)) << " for node " << *it
+           << " but its local branch has length " << length << std::endl;
+      return(0);
+    }
+    total += length;
+  }
+
+  // Also catches lengths that were not removed together with their nodes
+  if ( !areSame(total, branch_lengths_.total(), 0.000001) ) {
+    dout << "Error: Branch length index has total length " << branch_lengths_.total()
+         << " but should have " << total << std::endl;
+    return(0);
+  }
+
+  return(1);
+}
+
+
 bool Forest::checkInvariants(Node const* node) const {
   if (node == NULL) {
     bool okay = 1;
@@ -257,7 +284,9 @@ bool Forest::checkTree(Node const* root) const {
     good *= this->checkInvariants();
     good *= this->checkNodeProperties();
     good *= this->checkTreeLength();
+    good *= this->checkBranchLengths();
     good *= this->checkRoots();
+    good *= this->getNodes()->checkBranchIndex();
     return good;
   }
   assert( root != NULL );
@@ -621,11 +650,11 @@ bool Forest::checkRoots() const {
     return false;
   } 
   
-  // Check that primary_root() really is the primary root:
+  // Check that primary_root() really is the primary root, if it is known:
   Node* node = local_root();
   while (!node->is_root()) node = node->parent(); 
-  if (node != primary_root()) {
-    dout << primary_root() << " is registered as primary root, but "
+  if (primary_root_ != NULL && node != primary_root_) {
+    dout << primary_root_ << " is registered as primary root, but "
          << node << " is." << std::endl;
     return false;
   }
@@ -157,6 +157,7 @@ Node* Forest::cut(const TreePoint &cut_point) {
   new_root->set_population(cut_point.base_node()->population());
   cut_point.base_node()->set_parent(new_root);
   new_root->set_first_child(cut_point.base_node());
+  updateBranchLength(cut_point.base_node());
 
   // Set invariants of new root
   new_root->set_length_below(cut_point.base_node()->length_below() +
@@ -184,6 +185,11 @@ Node* Forest::cut(const TreePoint &cut_point) {
  * of a 'node' and all of its (grand-)parents. Also sets local_root_ if it
  * encounters it. Never makes non-local nodes local, only the other way round.
  *
+ * The update stops at the first node whose invariants and locality did not
+ * change, and above the local root at the first node that already is
+ * non-local. Changes of the primary root are therefore tracked where the
+ * trees are modified.
+ *
  *  \param node       The node at which the functions starts updating the
  *                    invariants. Then updates it's parent and the parents
  *                    parent.
@@ -199,80 +205,108 @@ void Forest::updateAbove(Node* node, bool above_local_root,
                          const bool &recursive, const bool &invariants_only) {
 
   //dout << "Updating: " << node << " above_local_root: " << above_local_root << std::endl;
+  STATS(++stats_.update_above_calls);
+
+  // The branches at the start node are the ones that the caller changed.
+  // Further up, a branch only changes its length if its node becomes
+  // non-local.
+  updateBranchLength(node);
+  if (node->first_child() != NULL) updateBranchLength(node->first_child());
+  if (node->second_child() != NULL) updateBranchLength(node->second_child());
+
+  // The nodes are updated in a loop from 'node' upwards, until the root is
+  // reached or neither the invariants nor the locality of a node changed.
+  while (true) {
+    STATS(++stats_.update_above_nodes);
+
+    // Fast forward above local root because this part is fairly straight forward
+    if (above_local_root) {
+      // Assure that everything is non-local. All nodes above a non-local node
+      // are already non-local, so we can stop there.
+      if (!node->local()) {
+        STATS(++stats_.update_above_stops);
+        return;
+      }
+      node->make_nonlocal(current_rec());
+      updateBranchLength(node);
 
-  // Fast forward above local root because this part is fairly straight forward
-  if (above_local_root) {
-    // Assure that everything is non-local
-    if (node->local()) node->make_nonlocal(current_rec());
-
-    // Update the primary root if needed
-    if ( node->is_root() ) {
-      if (node != primary_root()) {
+      if ( node->is_root() ) {
         set_primary_root(node);
+        return;
       }
-      return;
+      if ( !recursive ) return;
+      node = node->parent();
+      continue;
     }
-    if ( recursive ) updateAbove(node->parent(), true, true);
-    return;
-  }
-
-  node->set_last_change(current_rec());
 
-  // Calculate new values for samples_below and length_below for the current
-  // node
-  Node *l_child = node->first_child();
-  Node *h_child = node->second_child();
+    node->set_last_change(current_rec());
 
-  size_t samples_below = node->in_sample();
-  if (l_child != NULL) samples_below = l_child->samples_below();
-  if (h_child != NULL) samples_below += h_child->samples_below();
-  assert( samples_below <= this->sample_size() );
+    // Calculate new values for samples_below and length_below for the current
+    // node
+    Node *l_child = node->first_child();
+    Node *h_child = node->second_child();
 
-  double length_below = 0.0;
-  if (l_child != NULL) {
-    length_below += l_child->length_below();
-    if (l_child->local()) length_below += l_child->height_above();
+    size_t samples_below = node->in_sample();
+    if (l_child != NULL) samples_below = l_child->samples_below();
+    if (h_child != NULL) samples_below += h_child->samples_below();
+    assert( samples_below <= this->sample_size() );
 
-    if (h_child != NULL) {
-      length_below += h_child->length_below();
-      if (h_child->local()) length_below += h_child->height_above();
-    }
-  }
-  assert( length_below >= 0 );
+    double length_below = 0.0;
+    if (l_child != NULL) {
+      length_below += l_child->length_below();
+      if (l_child->local()) length_below += l_child->height_above();
 
-  // Update whether the node is local or not
-  if (!invariants_only) {
-    if (samples_below == 0) {
-      if ( node->local() ) node->make_nonlocal(current_rec());
+      if (h_child != NULL) {
+        length_below += h_child->length_below();
+        if (h_child->local()) length_below += h_child->height_above();
+      }
     }
-    else if ( samples_below == sample_size() ) {
-      if ( node->local() ) node->make_nonlocal(current_rec());
-
-      // Are we the local root?
-      if (node->countChildren() == 2 &&
-          l_child->samples_below() > 0 && h_child->samples_below() > 0) {
-        set_local_root(node);
+    assert( length_below >= 0 );
+
+    // Update whether the node is local or not
+    bool locality_changed = false;
+    if (!invariants_only) {
+      if (samples_below == 0) {
+        if ( node->local() ) {
+          node->make_nonlocal(current_rec());
+          locality_changed = true;
+        }
       }
-      if ( node->is_root() && node != primary_root() ) {
-        set_primary_root(node);
+      else if ( samples_below == sample_size() ) {
+        if ( node->local() ) {
+          node->make_nonlocal(current_rec());
+          locality_changed = true;
+        }
+
+        // Are we the local root?
+        if (node->countChildren() == 2 &&
+            l_child->samples_below() > 0 && h_child->samples_below() > 0) {
+          set_local_root(node);
+        }
+        if ( node->is_root() && node != primary_root_ ) {
+          set_primary_root(node);
+        }
+        above_local_root = true;
       }
-      above_local_root = true;
     }
-  }
 
-  // If nothing changed, we also don't need to update the tree further above...
-  if (samples_below == node->samples_below() &&
-      areSame(length_below, node->length_below()) ) {
-    return;
-  }
+    if (locality_changed) updateBranchLength(node);
+
+    // If nothing changed, we also don't need to update the tree further above...
+    if (!locality_changed &&
+        samples_below == node->samples_below() &&
+        areSame(length_below, node->length_below()) ) {
+      STATS(++stats_.update_above_stops);
+      return;
+    }
 
-  // Update the node invariants
-  node->set_samples_below(samples_below);
-  node->set_length_below(length_below);
+    // Update the node invariants
+    node->set_samples_below(samples_below);
+    node->set_length_below(length_below);
 
-  // Go further up if possible
-  if ( recursive && !node->is_root() ) {
-    updateAbove(node->parent(), above_local_root, recursive, invariants_only);
+    // Go further up if possible
+    if ( !recursive || node->is_root() ) return;
+    node = node->parent();
   }
 }
 
@@ -289,6 +323,7 @@ void Forest::buildInitialTree() {
   assert(this->rec_bases_.size() == 1);
   assert(this->model().getCurrentSequencePosition() == 0.0);
   assert(this->contemporaries()->empty());
+  STATS(stats_.startPhase(Stats::initial_tree));
   this->set_next_base(0.0);
   ++current_rec_;
 
@@ -324,8 +359,15 @@ void Forest::buildInitialTree() {
     assert(this->printNodes());
     assert(this->coalescence_finished());
   }
+#ifdef SCRM_BRANCH_INDEX
+  // The new samples are at the bottom of the tree, where the index does not
+  // help. It is built once the tree is complete.
+  if (model().sample_size() >= kBranchIndexMinSamples) nodes()->enableBranchIndex();
+#endif
   this->sampleNextBase();
   dout << "Next Sequence position: " << this->next_base() << std::endl;
+  STATS(++stats_.loci; ++stats_.segments);
+  STATS(stats_.max_nodes = std::max(stats_.max_nodes, nodes()->size()));
   this->calcSegmentSumStats();
 }
 
@@ -333,65 +375,96 @@ void Forest::buildInitialTree() {
 /**
  * Uniformly samples a TreePoint on the local tree.
  *
- * Its arguments are meant to be used only when the function iteratively calls
- * itself. Just call it without any arguments if you want to sample a TreePoint.
+ * The point is located with the segment tree over the local branch lengths in
+ * branch_lengths_, which takes O(log n) steps for trees of any shape. The
+ * branches are ordered by the slots of their nodes in the NodeContainer.
+ *
+ * \return The sampled point on the tree.
+ */
+TreePoint Forest::samplePoint() const {
+  assert( this->checkTreeLength() );
+  assert( this->checkBranchLengths() );
+
+  double length_left = random_generator()->sample() * branch_lengths_.total();
+  Node* node = getNodes()->slotNode(branch_lengths_.find(length_left));
+
+  assert( node->local() );
+  assert( 0 <= length_left && length_left < node->height_above() );
+  return TreePoint(node, length_left, true);
+}
+
+
+/**
+ * Finds the TreePoint at a given position below a node.
  *
- * The function first samples a part of the total height of the tree and then
- * goes down from the root, deciding at each node if that point is to the left
- * or right, which should give us an O(log(#nodes)) algorithm.
+ * Skips length_left of the local branches below 'node' in the order described
+ * below. Used for placing points of the local tree that are sampled elsewhere,
+ * e.g. mutations, at their branches.
  *
- * I checked the distribution of this function in multiple cases. -Paul
+ * The function goes down from the node, deciding at each node if that point
+ * is on the branch above it, or to the left or right below it. The branches
+ * are therefore ordered like in a pre-order traversal of the local tree.
+ * The descent is done in a loop and the length of the branch above a child is
+ * calculated from the height of the current node, so that only the children
+ * are dereferenced on the way down.
  *
- * \param node The current position in the tree when the functions goes down
- *             iteratively.
+ * \param node The node below which the point is located, including the branch
+ *             above it unless it is the local root.
  *
  * \param length_left The length that is left until we encounter the sampled
  *              length.
  *
- * \return The sampled point on the tree.
+ * \return The point on the tree.
  */
 TreePoint Forest::samplePoint(Node* node, double length_left) const {
-  if (node == NULL) {
-    // Called without arguments => initialization
-    assert( this->checkTreeLength() );
-
-    node = this->local_root();
-    length_left = random_generator()->sample() * getLocalTreeLength();
-    assert( 0 < length_left && length_left < getLocalTreeLength() );
-  }
-
   assert( node->local() || node == this->local_root() );
   assert( length_left >= 0 );
   assert( length_left < (node->length_below() + node->height_above()) );
 
   if ( node != this->local_root() ) {
-    if ( length_left < node->height_above() ) {
+    double height_above = node->height_above();
+    if ( length_left < height_above ) {
       assert( node->local() );
       return TreePoint(node, length_left, true);
     }
-
-    length_left -= node->height_above();
+    length_left -= height_above;
     assert( length_left >= 0 );
   }
 
-  // At this point, we should have at least one local child
-  assert( node->first_child() != NULL );
-  assert( node->first_child()->local() || node->second_child()->local() );
+  while (true) {
+    // At this point, we should have at least one local child
+    Node* first_child = node->first_child();
+    Node* second_child = node->second_child();
+    assert( first_child != NULL );
+    assert( first_child->local() || second_child->local() );
+
+    // If we have only one local child, then give it the full length we have
+    // left. If we have two local children, then look if we should go down
+    // left or right.
+    Node* child;
+    if ( !first_child->local() ) {
+      child = second_child;
+    } else if ( second_child == NULL || !second_child->local() ) {
+      child = first_child;
+    } else {
+      double tmp = (node->height() - first_child->height()) + first_child->length_below();
+      if ( length_left <= tmp ) {
+        child = first_child;
+      } else {
+        child = second_child;
+        length_left -= tmp;
+      }
+    }
 
-  // If we have only one local child, then give it the full length we have left.
-  if ( !node->first_child()->local() ) {
-    return samplePoint(node->second_child(), length_left);
-  }
-  if ( node->second_child() == NULL || !node->second_child()->local() ) {
-    return samplePoint(node->first_child(), length_left);
-  }
+    assert( child->local() );
+    assert( length_left < child->length_below() + child->height_above() );
+    double height_above = node->height() - child->height();
+    if ( length_left < height_above ) return TreePoint(child, length_left, true);
 
-  // If we have two local children, the look if we should go down left or right.
-  double tmp = node->first_child()->height_above() + node->first_child()->length_below();
-  if ( length_left <= tmp )
-    return samplePoint(node->first_child(), length_left);
-  else
-    return samplePoint(node->second_child(), length_left - tmp);
+    length_left -= height_above;
+    assert( length_left >= 0 );
+    node = child;
+  }
 }
 /* Alternative inefficient implementation
 TreePoint Forest::samplePoint(Node* node, double length_left) {
@@ -416,11 +489,19 @@ TreePoint Forest::samplePoint(Node* node, double length_left) {
  * @ingroup group_pf_update
  */
 void Forest::sampleNextGenealogy() {
+#ifdef SCRM_COMPACT_NODES
+  // The nodes store the recombination counter with 32 bits
+  if (current_rec_ == std::numeric_limits<NodeCount>::max())
+    throw std::out_of_range("Too many recombinations in one locus for compact nodes.");
+#endif
   ++current_rec_; // Move to next recombination;
+  STATS(stats_.startPhase(Stats::genealogies));
+  STATS(++stats_.segments);
 
   if (current_base() == model().getCurrentSequencePosition()) {
     // Don't implement a recombination if we are just here because rates changed
     dout << std::endl << "Position: " << this->current_base() << ": Changing rates." << std::endl;
+    STATS(++stats_.rate_changes);
     this->sampleNextBase();
     this->calcSegmentSumStats();
     dout << "Next Position: " << this->next_base() << std::endl;
@@ -446,6 +527,8 @@ void Forest::sampleNextGenealogy() {
   dout << "(above " << rec_point.base_node() << ")"<< std::endl;
 
   dout << "* Cutting subtree below recombination " << std::endl;
+  STATS(++stats_.recombinations);
+  STATS(double tree_length = getLocalTreeLength());
   this->cut(rec_point);
   assert( rec_point.height() == rec_point.base_node()->parent_height() );
   assert( this->printTree() );
@@ -458,6 +541,8 @@ void Forest::sampleNextGenealogy() {
   assert( this->printTree() );
   assert( this->printNodes() );
   assert( this->coalescence_finished() );
+  STATS(if (!areSame(tree_length, getLocalTreeLength())) ++stats_.tree_changes);
+  STATS(stats_.max_nodes = std::max(stats_.max_nodes, nodes()->size()));
 
   this->sampleNextBase();
   dout << "Next Sequence position: " << this->next_base() << std::endl;
@@ -502,7 +587,10 @@ void Forest::sampleCoalescences(Node *start_node) {
     states_[1] = getNodeState(active_node(1), (*ti).start_height());
 
     // Fixed time events (e.g pop splits/merges & single migration events first
-    if (model().hasFixedTimeEvent((*ti).start_height())) implementFixedTimeEvent(ti);
+    if (model().hasFixedTimeEvent((*ti).start_height())) {
+      STATS(++stats_.fixed_time_events);
+      implementFixedTimeEvent(ti);
+    }
 
     // Calculate the rates of events in this time interval
     assert( checkContemporaries((*ti).start_height()) );
@@ -539,23 +627,28 @@ void Forest::sampleCoalescences(Node *start_node) {
 
     // Implement the event
     if ( tmp_event_.isNoEvent() ) {
+      STATS(++stats_.no_events);
       this->implementNoEvent(*ti, coalescence_finished_);
     }
 
     else if ( tmp_event_.isPwCoalescence() ) {
+      STATS(++stats_.pw_coalescences);
       this->implementPwCoalescence(active_node(0), active_node(1), tmp_event_.time());
       this->coalescence_finished_ = true;
     }
 
     else if ( tmp_event_.isRecombination() ) {
+      STATS(++stats_.recombination_events);
       this->implementRecombination(tmp_event_, ti);
     }
 
     else if ( tmp_event_.isMigration() ) {
+      STATS(++stats_.migrations);
       this->implementMigration(tmp_event_, true, ti);
     }
 
     else if ( tmp_event_.isCoalescence() ) {
+      STATS(++stats_.coalescences);
       this->implementCoalescence(tmp_event_, ti);
       assert( checkInvariants(tmp_event_.node()) );
       assert( this->printTree() );
@@ -885,6 +978,10 @@ void Forest::implementCoalescence(const Event &event, TimeIntervalIterator &tii)
   Node* coal_node = event.node();
   Node* target = contemporaries_.sample(coal_node->population());
 
+  // If the primary root coalesces, the root of the target's tree becomes the
+  // new primary root. It is determined after the coalescence finished.
+  if (coal_node == primary_root_) set_primary_root(NULL);
+
   dout << "* * * Above node " << target << std::endl;
   assert( target->height() < event.time() );
   assert( coal_node->population() == target->population() );
@@ -910,6 +1007,7 @@ void Forest::implementCoalescence(const Event &event, TimeIntervalIterator &tii)
     new_node = nodes()->createNode(event.time());
     new_node->change_child(NULL, coal_node);
     coal_node->set_parent(new_node);
+    new_node->set_population(coal_node->population());
     nodes()->add(new_node);
   }
 
@@ -919,7 +1017,7 @@ void Forest::implementCoalescence(const Event &event, TimeIntervalIterator &tii)
   // new_node:  New parent of 'target' and 'coal_node'
 
   // Update new_node
-  new_node->set_population(coal_node->population());
+  nodes()->set_population(new_node, coal_node->population());
   new_node->change_child(NULL, target);
   new_node->set_parent(target->parent());
   if (!target->local()) {
@@ -1029,6 +1127,7 @@ void Forest::implementPwCoalescence(Node* root_1, Node* root_2, const double tim
   else {
     // No tree a has single branch on top => create a new root
     new_root = nodes()->createNode(time);
+    new_root->set_population(root_1->population());
     this->nodes()->add(new_root);
   }
 
@@ -1036,11 +1135,14 @@ void Forest::implementPwCoalescence(Node* root_1, Node* root_2, const double tim
   root_2->set_parent(new_root);
   new_root->set_second_child(root_1);
   new_root->set_first_child(root_2);
-  new_root->set_population(root_1->population());
+  nodes()->set_population(new_root, root_1->population());
 
   updateAbove(root_1, false, false);
   updateAbove(root_2, false, false);
   updateAbove(new_root, false, false);
+
+  // The new root is above all samples, and hence the primary root.
+  set_primary_root(new_root);
   dout << " done" << std::endl;
 
   assert( this->local_root()->height() == time );
@@ -1051,6 +1153,10 @@ void Forest::implementPwCoalescence(Node* root_1, Node* root_2, const double tim
 
 
 void Forest::implementRecombination(const Event &event, TimeIntervalIterator &ti) {
+  // If the recombination is above the local tree, the subtree that is cut away
+  // may contain it and gets a new root.
+  set_primary_root(NULL);
+
   TreePoint event_point = TreePoint(event.node(), event.time(), false);
   set_active_node(event.active_node_nr(), cut(event_point));
 
@@ -1070,18 +1176,19 @@ void Forest::implementMigration(const Event &event, const bool &recalculate, Tim
        ( event.node()->height() == event.time() && event.node()->is_migrating() ) ) {
     dout << "Reusing: " << event.node() << "... " << std::flush;
     nodes()->move(event.node(), event.time());
-    event.node()->set_population(event.mig_pop());
+    nodes()->set_population(event.node(), event.mig_pop());
     updateAbove(event.node());
   } else {
     // Otherwise create a new node that marks the migration event,
     Node* mig_node = nodes()->createNode(event.time());
     dout << "Marker: " << mig_node << "... " << std::flush;
-    nodes()->add(mig_node, event.node());
     mig_node->set_population(event.mig_pop());
+    nodes()->add(mig_node, event.node());
 
     // integrate it into the tree
     event.node()->set_parent(mig_node);
     mig_node->set_first_child(event.node());
+    if (event.node() == primary_root_) set_primary_root(mig_node);
     updateAbove(event.node(), false, false);
     updateAbove(mig_node);
 
@@ -1091,6 +1198,7 @@ void Forest::implementMigration(const Event &event, const bool &recalculate, Tim
 
     // Now make the event node local
     event.node()->make_local();
+    updateBranchLength(event.node());
   }
   // Recalculate the interval
   if (recalculate) ti.recalculateInterval();
@@ -1169,10 +1277,10 @@ bool Forest::pruneNodeIfNeeded(Node* node, const bool prune_orphans) {
       dout << "* * * PRUNING: Removing node " << node << " from tree (orphaned)" << std::endl;
       assert(node != local_root());
       // If we are removing the primary root, it is difficult to find the new
-      // primary root. It should however be automatically set during the updates
-      // of the current coalescence.
-      if (node == primary_root()) set_primary_root(NULL);
+      // primary root. It is determined after the current coalescence.
+      if (node == primary_root_) set_primary_root(NULL);
       nodes()->remove(node);
+      STATS(++stats_.pruned_orphans);
       return true;
     }
     // Other roots stay
@@ -1183,6 +1291,7 @@ bool Forest::pruneNodeIfNeeded(Node* node, const bool prune_orphans) {
       // Old nodes have to go, no matter what
       dout << "* * * PRUNING: Removing branch above " << node << " from tree (old)" << std::endl;
       assert(!node->is_root());
+      STATS(++stats_.pruned_old);
 
       node->parent()->change_child(node, NULL);
       if (node->countChildren() == 0) nodes()->remove(node);
@@ -1193,6 +1302,9 @@ bool Forest::pruneNodeIfNeeded(Node* node, const bool prune_orphans) {
         Node* parent = node->parent();
         node->set_parent(NULL);
         updateAbove(parent, false, true, true);
+
+        // The separated subtree may contain the local tree
+        set_primary_root(NULL);
       }
       return true;
     }
@@ -1207,7 +1319,11 @@ bool Forest::pruneNodeIfNeeded(Node* node, const bool prune_orphans) {
       Node* child = node->first_child();
       child->set_parent(node->parent());
       node->parent()->change_child(node, child);
+      // The child's branch now also covers the one of the removed node
+      updateBranchLength(child);
+      branch_lengths_.set(nodes()->slot(node), 0.0);
       nodes()->remove(node);
+      STATS(++stats_.pruned_unneeded);
       return true;
     }
   }
@@ -1217,6 +1333,7 @@ bool Forest::pruneNodeIfNeeded(Node* node, const bool prune_orphans) {
 
 
 void Forest::calcSegmentSumStats() {
+  STATS(stats_.startPhase(Stats::summary_statistics));
   for (size_t i = 0; i < model().countSummaryStatistics(); ++i) {
     model().getSummaryStatistic(i)->calculate(*this);
   }
@@ -1230,14 +1347,16 @@ void Forest::clearSumStats() {
 }
 
 
-void Forest::printLocusSumStats(std::ostream &output) const {
+void Forest::printLocusSumStats(OutputBuffer &output) const {
+  STATS(stats_.startPhase(Stats::output));
   for (size_t i = 0; i < model().countSummaryStatistics(); ++i) {
     model().getSummaryStatistic(i)->printLocusOutput(output);
   }
 }
 
 
-void Forest::printSegmentSumStats(std::ostream &output) const {
+void Forest::printSegmentSumStats(OutputBuffer &output) const {
+  STATS(stats_.startPhase(Stats::output));
   for (size_t i = 0; i < model().countSummaryStatistics(); ++i) {
     model().getSummaryStatistic(i)->printSegmentOutput(output);
   }
@@ -1251,6 +1370,7 @@ void Forest::clear() {
 
   // Clear nodes
   nodes()->clear();
+  branch_lengths_.clear();
   contemporaries()->clear(true);
 
   // Reset Position & Segment Counts
@@ -1259,6 +1379,7 @@ void Forest::clear() {
   this->current_rec_ = 0;
 
   // Clear Summary Statistics
+  STATS(stats_.startPhase(Stats::summary_statistics));
   this->clearSumStats();
 
   // Reset Model
@@ -1268,7 +1389,7 @@ void Forest::clear() {
 
 
 
-Node* Forest::readNewickNode( std::string &in_str, std::string::iterator &it, size_t parenthesis_balance, Node* const parent ){
+Node* Forest::readNewickNode( std::string &in_str, std::string::iterator &it, size_t parenthesis_balance, Node* const parent, double* branch_length ){
   Node * node = nodes()->createNode( (double)0.0, (size_t)0 );
   node->set_parent ( parent );
   node->make_local();
@@ -1279,16 +1400,18 @@ Node* Forest::readNewickNode( std::string &in_str, std::string::iterator &it, si
     dout << "\""<<(*it) <<"\"" ;
     if        ( (*it) == '(' )  { // Start of a internal node, extract a new node
       parenthesis_balance++;
-      Node* child_1 = this->readNewickNode ( in_str, it = (it+1),parenthesis_balance, node );
+      double bl_1 = 0.0;
+      Node* child_1 = this->readNewickNode ( in_str, it = (it+1),parenthesis_balance, node, &bl_1 );
       node->set_first_child ( child_1 );
       this->nodes()->add( child_1 );
       if ( node->first_child() != NULL)
-        node->set_height ( node->first_child()->height() + 40000*node->first_child()->bl()  ) ;
+        node->set_height ( node->first_child()->height() + 40000*bl_1  ) ;
     } else if ( (*(it+1)) == ',' ){ //
-      node->extract_bl_and_label(it);
+      double bl = node->extract_bl_and_label(it);
+      if (branch_length != NULL) *branch_length = bl;
       dout << " " << parent
            << " has first child node " << node
-           << " with branch length "   << node->bl()
+           << " with branch length "   << bl
            << ", and with the label "  << node->label()
            << ", height "              << node->height()
            << " ]  Node " << node << " closed " << std::endl;
@@ -1300,10 +1423,11 @@ Node* Forest::readNewickNode( std::string &in_str, std::string::iterator &it, si
       this->nodes()->add( child_2 );
     } else if ( (*(it+1)) == ')'  ){
       // Before return, extract the branch length for the second node
-      node->extract_bl_and_label(it);
+      double bl = node->extract_bl_and_label(it);
+      if (branch_length != NULL) *branch_length = bl;
       dout << " " << parent
            << " has second child node " << node
-           << " with branch length "   << node->bl()
+           << " with branch length "   << bl
            << ", and with the label "  << node->label()
            << ", height "              << node->height()
            << " ]  Node " << node << " closed " << std::endl;
@@ -1324,6 +1448,8 @@ Node* Forest::readNewickNode( std::string &in_str, std::string::iterator &it, si
 
 
 void Forest::readNewick( std::string &in_str ){
+  STATS(stats_.startPhase(Stats::initial_tree));
+  STATS(++stats_.loci; ++stats_.segments);
   this->set_next_base(0.0);
   ++current_rec_;
   std::string::iterator it = in_str.begin();
@@ -1332,6 +1458,9 @@ void Forest::readNewick( std::string &in_str ){
   this->set_primary_root(this->nodes()->last() );
   dout << std::endl<<"there are "<< this->nodes()->size() << " nodes " << std::endl;
   (void)this->nodes()->sorted();
+#ifdef SCRM_BRANCH_INDEX
+  if (model().sample_size() >= kBranchIndexMinSamples) nodes()->enableBranchIndex();
+#endif
   for (auto it = nodes()->iterator(); it.good(); ++it) {
     updateAbove(*it, false, false);
   }
@@ -42,12 +42,14 @@
 
 #include <vector>
 #include <unordered_set>
+#include <limits>
 #include <stdexcept>
 #include <cassert>
 #include <iostream> // ostreams
 #include <iomanip>  // Used for debug output
 #include <sstream>  // Used for debug output
 
+#include "branch_length_index.h"
 #include "contemporaries_container.h"
 #include "event.h"
 #include "model.h"
@@ -56,6 +58,7 @@
 #include "node_container.h"
 #include "time_interval.h"
 #include "tree_point.h"
+#include "stats.h"
 #include "random/random_generator.h"
 #include "summary_statistics/summary_statistic.h"
 
@@ -66,7 +69,7 @@ enum eventCode { NOEVENT, EVENT, INIT_NULL};
 class Forest
 {
  public:
-  Node* readNewickNode( std::string &in_str, std::string::iterator &current_it, size_t parenthesis_balance = 0, Node* parent = NULL );
+  Node* readNewickNode( std::string &in_str, std::string::iterator &current_it, size_t parenthesis_balance = 0, Node* parent = NULL, double* branch_length = NULL );
   void readNewick(std::string &in_str);
   ContemporariesContainer* contemporaries()  {return &this->contemporaries_;};
 
@@ -92,7 +95,15 @@ class Forest
   Node* local_root() const { return local_root_; }
   void set_local_root(Node* local_root) { local_root_ = local_root; };
 
-  Node* primary_root() const { return primary_root_; }
+  // The primary root is searched from the local root if it is unknown, e.g.
+  // after pruning or recombinations during a coalescence.
+  Node* primary_root() const {
+    if (primary_root_ == NULL && local_root_ != NULL) {
+      primary_root_ = local_root_;
+      while (!primary_root_->is_root()) primary_root_ = primary_root_->parent();
+    }
+    return primary_root_;
+  }
   void set_primary_root(Node* primary_root) { primary_root_ = primary_root; };
 
   size_t sample_size() const {
@@ -103,6 +114,13 @@ class Forest
 
   size_t segment_count() const { return current_rec_; }
 
+#ifdef SCRM_STATS
+  const Stats &stats() const {
+    stats_.updateTime();
+    return stats_;
+  }
+#endif
+
   void sampleNextBase();
 
   /**
@@ -133,7 +151,8 @@ class Forest
   // Central functions
   void buildInitialTree();
   void sampleNextGenealogy();
-  TreePoint samplePoint(Node* node = NULL, double length_left = -1) const;
+  TreePoint samplePoint() const;
+  TreePoint samplePoint(Node* node, double length_left) const;
 
   void clear();
 
@@ -145,6 +164,7 @@ class Forest
   bool checkTree(Node const* root = NULL) const;
   double calcTreeLength() const;
   bool checkTreeLength() const;
+  bool checkBranchLengths() const;
   bool checkInvariants(Node const* node = NULL) const;
   bool checkNodeProperties() const;
   bool checkContemporaries(const double time) const;
@@ -189,8 +209,8 @@ class Forest
   // Calc & Print Summary Statistics
   void calcSegmentSumStats();
   void clearSumStats();
-  void printLocusSumStats(std::ostream &output) const;
-  void printSegmentSumStats(std::ostream &output) const;
+  void printLocusSumStats(OutputBuffer &output) const;
+  void printSegmentSumStats(OutputBuffer &output) const;
 
   double get_rec_base(const size_t idx) const {
     return rec_bases_.at(idx);
@@ -216,6 +236,11 @@ class Forest
                    const bool &recursive = true,
                    const bool &invariants_only = false);
 
+  // Stores the length of the local branch above 'node' in branch_lengths_.
+  void updateBranchLength(Node const* node) {
+    branch_lengths_.set(nodes_.slot(node), node->local() ? node->height_above() : 0.0);
+  }
+
   // Tools for doing coalescence & recombination
   void sampleCoalescences(Node *start_node);
   size_t getNodeState(Node const *node, const double current_time) const;
@@ -276,12 +301,24 @@ class Forest
   // Private Members
   NodeContainer nodes_;    // The nodes of the Tree/Forest
 
+#ifdef SCRM_BRANCH_INDEX
+  // The smallest sample size for which the nodes_ maintain their branch index.
+  // For smaller samples, iterating over the nodes is faster than the index.
+  static const size_t kBranchIndexMinSamples = 1000;
+#endif
+
+  // The lengths of the local branches, indexed by the slots of their nodes
+  // in nodes_. Kept up to date by updateAbove() and the few modifications
+  // that change a branch without updating the node above it.
+  BranchLengthIndex branch_lengths_;
+
   // We have 3 different kind of roots that are important:
   // local root: root of the smallest subtree containing all local sequences
   Node* local_root_;
 
-  // primary root: root of the tree that contains all local sequences
-  Node* primary_root_;
+  // primary root: root of the tree that contains all local sequences, or NULL
+  // if it is unknown.
+  mutable Node* primary_root_;
 
   // secondary roots: roots of trees that contain only non-local nodes
   // std::unordered_set<Node*> secondary_roots_;
@@ -289,6 +326,11 @@ class Forest
   size_t sample_size_;      // The number of sampled nodes (changes while building the initial tree)
   size_t current_rec_;      // A counter for recombinations
 
+#ifdef SCRM_STATS
+  // Mutable, because printing the summary statistics starts the output phase
+  mutable Stats stats_;
+#endif
+
   std::vector<double> rec_bases_; // Genetic positions of the recombinations
 
   Model* model_;
@@ -21,6 +21,12 @@
 
 #include "model.h"
 
+#include <map>
+
+#include "summary_statistics/seg_sites.h"
+#include "summary_statistics/frequency_spectrum.h"
+#include "summary_statistics/sfs_statistics.h"
+
 
 Model::Model() : 
   has_migration_(false),
@@ -548,6 +554,55 @@ void Model::finalize() {
 }
 
 
+/**
+ * @brief Replaces the summary statistics of the model with independent copies.
+ *
+ * Copies of a model share their summary statistics by default. Use this on a
+ * copy that simulates loci concurrently with the original model, so that both
+ * can calculate and print statistics without interfering.
+ */
+void Model::cloneSummaryStatistics() {
+  std::map<SummaryStatistic const*, std::shared_ptr<SegSites> > seg_sites;
+  std::map<SummaryStatistic const*, std::shared_ptr<FrequencySpectrum> > spectra;
+  for (auto &sum_stat : summary_statistics_) {
+    SummaryStatistic const* original = sum_stat.get();
+    sum_stat = std::shared_ptr<SummaryStatistic>(original->clone());
+    if (dynamic_cast<SegSites const*>(original) != NULL) {
+      seg_sites[original] = std::static_pointer_cast<SegSites>(sum_stat);
+    }
+    if (dynamic_cast<FrequencySpectrum const*>(original) != NULL) {
+      spectra[original] = std::static_pointer_cast<FrequencySpectrum>(sum_stat);
+    }
+  }
+
+  // The frequency spectrum reads the mutations from a SegSites object, which
+  // must be the copy owned by this model.
+  for (auto &sum_stat : summary_statistics_) {
+    FrequencySpectrum* sfs = dynamic_cast<FrequencySpectrum*>(sum_stat.get());
+    if (sfs == NULL) continue;
+    auto it = seg_sites.find(sfs->seg_sites().get());
+    if (it != seg_sites.end()) sfs->set_seg_sites(it->second);
+    else sfs->set_seg_sites(std::shared_ptr<SegSites>(sfs->seg_sites()->clone()));
+  }
+
+  // Likewise, statistics based on the frequency spectrum must share the copy
+  // of it, which is created here if it is not a statistic of its own.
+  for (auto &sum_stat : summary_statistics_) {
+    SfsStatistic* statistic = dynamic_cast<SfsStatistic*>(sum_stat.get());
+    if (statistic == NULL) continue;
+    SummaryStatistic const* original = statistic->frequency_spectrum().get();
+    if (spectra.count(original) == 0) {
+      std::shared_ptr<FrequencySpectrum> sfs(statistic->frequency_spectrum()->clone());
+      auto it = seg_sites.find(sfs->seg_sites().get());
+      if (it != seg_sites.end()) sfs->set_seg_sites(it->second);
+      else sfs->set_seg_sites(std::shared_ptr<SegSites>(sfs->seg_sites()->clone()));
+      spectra[original] = sfs;
+    }
+    statistic->set_frequency_spectrum(spectra[original]);
+  }
+}
+
+
 void Model::calcPopSizes() {
   // Set initial population sizes
   if (pop_sizes_list_.at(0).empty()) addPopulationSizes(0, default_pop_size());
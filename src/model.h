@@ -404,6 +404,8 @@ class Model
      summary_statistics_.push_back(sum_stat);
    }
 
+   void cloneSummaryStatistics();
+
   void addPopulation();
 
   SeqScale getSequenceScaling() const { return seq_scale_; }
@@ -27,12 +27,47 @@
 #include<iostream>
 
 
+#ifdef SCRM_NODE_HANDLES
+Node* NodeArena::lanes_[NodeArena::kMaxLanes] = { };
+std::vector<size_t> NodeArena::free_lanes_;
+size_t NodeArena::lane_count_ = 0;
+std::mutex NodeArena::mutex_;
+
+size_t NodeArena::registerLane(Node* lane) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  size_t lane_id;
+  if (free_lanes_.size() > 0) {
+    lane_id = free_lanes_.back();
+    free_lanes_.pop_back();
+  } else {
+    if (lane_count_ == kMaxLanes) throw std::length_error("Too many nodes for 32-bit node handles");
+    lane_id = lane_count_++;
+  }
+  lanes_[lane_id] = lane;
+  return lane_id;
+}
+
+void NodeArena::releaseLane(const size_t lane_id) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  assert( lanes_[lane_id] != NULL );
+  lanes_[lane_id] = NULL;
+  free_lanes_.push_back(lane_id);
+}
+#endif
+
 Node::Node() { init(); }
 Node::Node(double height) { init(height); }
 Node::Node(double height, size_t label) { init(height, label); }
 Node::~Node() {}
 
 void Node::init(double height, size_t label) {
+  this->resetIndex();
+  this->set_parent(NULL);
+  this->set_second_child(NULL);
+  this->set_first_child(NULL);
+  this->set_previous(NULL);
+  this->set_next(NULL);
+
   this->set_last_update(0);
   this->set_population(0);
 
@@ -42,12 +77,12 @@ void Node::init(double height, size_t label) {
   else this->set_samples_below(0); 
   this->set_length_below(0);
   this->set_last_change(0);
-
-  this->set_parent(NULL);
-  this->set_second_child(NULL);
-  this->set_first_child(NULL);
-  this->set_previous(NULL);
-  this->set_next(NULL);
+  this->contemporaries_index_ = 0;
+#ifdef SCRM_NODE_HANDLES
+  this->handle_ = kNullLink;
+#else
+  this->slot_ = 0;
+#endif
 }
   
 
@@ -149,14 +184,15 @@ Node* Node::getLocalChild2() const {
 }
 
 
-void Node::extract_bl_and_label ( std::string::iterator in_it ){
+// Reads the label of the node from a newick tree and returns the length of
+// the branch above it, which is only needed while reading the tree.
+double Node::extract_bl_and_label ( std::string::iterator in_it ){
   // Going backwards, extract branch length first, then the node label
   std::string::iterator bl_start = in_it;
   //for (; (*(bl_start-1)) != ':'; --bl_start ){ }
   while ((*(bl_start-1)) != ':')
     --bl_start;
   double bl = strtod( &(*bl_start), NULL );
-  this->set_bl ( bl );
 
   std::string::iterator label_start = (bl_start-2);
 
@@ -165,5 +201,6 @@ void Node::extract_bl_and_label ( std::string::iterator in_it ){
 
   this->set_label ( ( (*(label_start)) == ')' ? 0 /*! Label internal nodes */
                                                 : strtol ( &(*(label_start+1)), NULL , 10)) ); /*! Label tip nodes */
+  return bl;
 }
 
@@ -38,6 +38,68 @@
 #include <iostream>
 #include <cassert>
 #include <string>
+#include <cstdint>
+#include <algorithm>
+#include <mutex>
+#include <vector>
+
+class Node;
+
+/**
+ * Storage for links between nodes.
+ *
+ * By default, nodes are linked by plain pointers. When compiled with
+ * SCRM_NODE_HANDLES, they are linked by 32-bit handles instead. A handle
+ * addresses a slot in the process-wide NodeArena: its upper bits select a
+ * lane of kLaneSize nodes, its lower bits the node within that lane.
+ * The public interface of Node uses Node* in both modes.
+ */
+#ifdef SCRM_NODE_HANDLES
+typedef uint32_t NodeLink;
+const NodeLink kNullLink = UINT32_MAX;
+
+class NodeArena {
+ public:
+  static const size_t kLaneBits = 14;
+  static const size_t kLaneSize = 1 << kLaneBits;
+  static const size_t kMaxLanes = (size_t(1) << (32 - kLaneBits)) - 1;
+
+  static Node* resolve(const NodeLink link);
+
+  static NodeLink handle(const size_t lane_id, const size_t pos) {
+    assert( pos < kLaneSize );
+    return (NodeLink)((lane_id << kLaneBits) | pos);
+  }
+
+  // Registers a lane of kLaneSize nodes and returns its id.
+  static size_t registerLane(Node* lane);
+  static void releaseLane(const size_t lane_id);
+
+ private:
+  static Node* lanes_[kMaxLanes];
+  static std::vector<size_t> free_lanes_;
+  static size_t lane_count_;
+  static std::mutex mutex_;
+};
+
+#else
+typedef Node* NodeLink;
+const NodeLink kNullLink = NULL;
+#endif
+
+/**
+ * Storage for the labels, populations, sample counts and recombination
+ * counters of a node.
+ *
+ * When compiled with SCRM_COMPACT_NODES, they are stored with 32 bits
+ * instead of 64 bits. Together with SCRM_NODE_HANDLES, a node then occupies
+ * 64 bytes instead of 112 bytes.
+ */
+#ifdef SCRM_COMPACT_NODES
+typedef uint32_t NodeCount;
+#else
+typedef size_t NodeCount;
+#endif
 
 
 class Node
@@ -49,17 +111,22 @@ class Node
   friend class TestNodeContainer;
 #endif
   friend class NodeContainer;
+  friend class ContemporariesContainer;
   
   ~Node();
 
   //Getters & Setters
-  void extract_bl_and_label ( std::string::iterator in_it );
-  double bl_;
-  double bl() const { return this->bl_; }
-  void set_bl ( double bl ) { this->bl_ = bl; }
+  double extract_bl_and_label ( std::string::iterator in_it );
 
   double height() const { return this->height_; }
-  void set_height(const double height) { this->height_ = height; }
+  void set_height(const double height) { 
+    this->height_ = height; 
+#ifdef SCRM_BRANCH_INDEX
+    // The branches above the children now end at a different height
+    if (first_child_ != kNullLink && first_child()->in_index()) first_child()->updateIndex();
+    if (second_child_ != kNullLink && second_child()->in_index()) second_child()->updateIndex();
+#endif
+  }
 
   double parent_height() const {
     if ( this->is_root() ) return this->height();
@@ -69,7 +136,13 @@ class Node
   double height_above() const { return this->parent_height() - this->height(); }
 
   size_t population() const { return population_; }
-  void set_population(const size_t pop) { population_ = pop; }
+  void set_population(const size_t pop) { 
+#ifdef SCRM_BRANCH_INDEX
+    // The branch index is organized by population, see NodeContainer::set_population
+    assert( !in_index() || pop == population_ );
+#endif
+    population_ = pop; 
+  }
 
   bool local() const { return (last_update_ == 0); }
 
@@ -82,16 +155,21 @@ class Node
   }
 
 	Node *parent() const {
-    assert( this->parent_ != NULL ); 
-    return this->parent_; 
+    assert( this->parent_ != kNullLink ); 
+    return deref(this->parent_); 
+  }
+  void set_parent(Node *parent) { 
+    this->parent_ = link(parent); 
+#ifdef SCRM_BRANCH_INDEX
+    if (in_index()) updateIndex();
+#endif
   }
-  void set_parent(Node *parent) { this->parent_ = parent; }
 
-  Node *second_child() const { return this->second_child_; }
-  void set_second_child(Node *second_child) { this->second_child_ = second_child; }
+  Node *second_child() const { return deref(this->second_child_); }
+  void set_second_child(Node *second_child) { this->second_child_ = link(second_child); }
 
-  Node *first_child() const { return this->first_child_; }
-  void set_first_child(Node *first_child) { this->first_child_ = first_child; }
+  Node *first_child() const { return deref(this->first_child_); }
+  void set_first_child(Node *first_child) { this->first_child_ = link(first_child); }
 
   size_t last_update() const { return last_update_; }
 
@@ -110,15 +188,15 @@ class Node
   void set_label(size_t label) { label_ = label; }
   size_t label() const { return label_; }
 
-  bool is_root() const { return ( this->parent_ == NULL ); }
+  bool is_root() const { return ( this->parent_ == kNullLink ); }
   bool in_sample() const {
     return ( this->label() != 0 ); 
   }
 
   bool is_migrating() const; 
 
-  bool is_first() const { return( previous_ == NULL ); }
-  bool is_last() const { return( next_ == NULL ); }
+  bool is_first() const { return( previous_ == kNullLink ); }
+  bool is_last() const { return( next_ == kNullLink ); }
 
   // Uminportant Nodes are nodes that sit at the top of the single 
   // top branch of a tree after it got cut away from the primary tree. 
@@ -134,16 +212,16 @@ class Node
   void remove_child(Node* child);
 
   Node* next() const { 
-    if ( next_ == NULL ) throw std::out_of_range("Node has no next node");
-    return next_; 
+    if ( next_ == kNullLink ) throw std::out_of_range("Node has no next node");
+    return deref(next_); 
   }
   Node* previous() const { 
-    if ( previous_ == NULL ) throw std::out_of_range("Node has no previous node");
-    return previous_; 
+    if ( previous_ == kNullLink ) throw std::out_of_range("Node has no previous node");
+    return deref(previous_); 
   }
 
-  void set_next(Node* next) { next_ = next; }
-  void set_previous(Node* previous) { previous_ = previous; }
+  void set_next(Node* next) { next_ = link(next); }
+  void set_previous(Node* previous) { previous_ = link(previous); }
 
   // Navigate on local tree
   Node *getLocalParent() const;
@@ -158,28 +236,126 @@ class Node
   void init(double heigh=-1, size_t label=0);
   void set_last_update(const size_t recombination) { last_update_ = recombination; }; 
 
-  size_t label_;
+  // The branch index of the NodeContainer
+#ifdef SCRM_BRANCH_INDEX
+  bool in_index() const { return index_priority_ != 0; }
+  double index_value() const { 
+    if (is_root()) return -DBL_MAX;
+    return parent()->height();
+  }
+  void updateIndex();
+  void resetIndex() {
+    index_up_ = kNullLink;
+    index_left_ = kNullLink;
+    index_right_ = kNullLink;
+    index_max_ = -DBL_MAX;
+    index_priority_ = 0;
+  }
+  void resetOrder() {
+    order_up_ = kNullLink;
+    order_left_ = kNullLink;
+    order_right_ = kNullLink;
+    order_size_ = 0;
+  }
+#else
+  void resetIndex() { }
+  void resetOrder() { }
+#endif
+
+  // Conversion between Node* and the stored links
+#ifdef SCRM_NODE_HANDLES
+  static Node* deref(const NodeLink link) {
+    if (link == kNullLink) return NULL;
+    return NodeArena::resolve(link);
+  }
+  static NodeLink link(const Node* node) {
+    if (node == NULL) return kNullLink;
+    assert( node->handle_ != kNullLink ); // Only nodes from a NodeContainer
+    assert( NodeArena::resolve(node->handle_) == node );
+    return node->handle_;
+  }
+#else
+  static Node* deref(const NodeLink link) { return link; }
+  static NodeLink link(const Node* node) { return const_cast<Node*>(node); }
+#endif
+
   double height_;        // The total height of the node
-  size_t last_update_;   // The recombination on which the branch above the node
-                         // was last checked for recombination events or 0 if
-                         // the node is local 
-  size_t last_change_;   // The recombination at which the subtree below the node
-                         // changed most recently.
+  double length_below_;  // the total length of local branches in the subtree below this node
+
+  NodeCount label_;
+  NodeCount last_update_;   // The recombination on which the branch above the node
+                            // was last checked for recombination events or 0 if
+                            // the node is local 
+  NodeCount last_change_;   // The recombination at which the subtree below the node
+                            // changed most recently.
 
-  size_t population_;    // The number of the population the node belong to. 
+  NodeCount population_;    // The number of the population the node belong to. 
   
-  size_t samples_below_; // the number of sampled nodes in the subtree below this node
-  double length_below_;  // the total length of local branches in the subtree below this node
+  NodeCount samples_below_; // the number of sampled nodes in the subtree below this node
+
+  NodeCount contemporaries_index_; // The position of the node in the ContemporariesContainer
 
-  Node* next_;
-  Node* previous_;
+  NodeLink next_;
+  NodeLink previous_;
 
   //The tree structure
-  Node *parent_;
-  Node *first_child_;
-  Node *second_child_;
+  NodeLink parent_;
+  NodeLink first_child_;
+  NodeLink second_child_;
+
+#ifdef SCRM_BRANCH_INDEX
+  // When the branch index is enabled, the NodeContainer additionally
+  // organizes the nodes of each population in a treap that has the same order
+  // as the list above. Each node in a treap stores the highest parent height
+  // in its subtree, which allows to find the branches of a population that
+  // cross a given time without visiting all nodes below it.
+  NodeLink index_up_;
+  NodeLink index_left_;
+  NodeLink index_right_;
+  double index_max_;
+  uint32_t index_priority_; // 0 if the node is not in the index
+
+  // Once the container holds many nodes, all nodes are also organized in a
+  // second treap in the order of the list. The size of each subtree gives
+  // the positions of the nodes.
+  NodeLink order_up_;
+  NodeLink order_left_;
+  NodeLink order_right_;
+  uint32_t order_size_;     // 0 if the node is not in the order index
+#endif
+
+#ifdef SCRM_NODE_HANDLES
+  NodeLink handle_;      // The handle addressing this node itself, assigned
+                         // by the NodeContainer that stores the node.
+#else
+  NodeCount slot_;       // The position of the node in the lanes of the
+                         // NodeContainer that stores the node.
+#endif
 };
 
+#ifdef SCRM_NODE_HANDLES
+inline Node* NodeArena::resolve(const NodeLink link) {
+  assert( link != kNullLink );
+  assert( lanes_[link >> kLaneBits] != NULL );
+  return lanes_[link >> kLaneBits] + (link & (kLaneSize - 1));
+}
+#endif
+
+#ifdef SCRM_BRANCH_INDEX
+// Updates the maximal parent heights stored in the branch index after the
+// parent height of this node changed.
+inline void Node::updateIndex() {
+  assert( in_index() );
+  for (Node* node = this; node != NULL; node = deref(node->index_up_)) {
+    double max = node->index_value();
+    if (node->index_left_ != kNullLink) max = std::max(max, deref(node->index_left_)->index_max_);
+    if (node->index_right_ != kNullLink) max = std::max(max, deref(node->index_right_)->index_max_);
+    if (max == node->index_max_) return;
+    node->index_max_ = max;
+  }
+}
+#endif
+
 inline bool Node::is_migrating() const { 
   if ( this->countChildren() != 1 ) return false;
   return ( this->population() != this->first_child()->population() );
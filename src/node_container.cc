@@ -31,24 +31,28 @@ NodeContainer::NodeContainer() {
   set_last(NULL);
   unsorted_node_ = NULL;
   size_ = 0;
+  branch_index_ = false;
+  index_counter_ = 0;
+  order_index_ = false;
+  order_root_ = NULL;
 
   node_counter_ = 0;
   lane_counter_ = 0;
-  std::vector<Node>* new_lane = new std::vector<Node>();
-  new_lane->reserve(10000);
-  node_lanes_.push_back(new_lane);
+  addLane();
 }
 
 NodeContainer::NodeContainer(const NodeContainer &nc) {
   size_ = 0;
   set_first(NULL);
   set_last(NULL);
+  branch_index_ = false;
+  index_counter_ = 0;
+  order_index_ = false;
+  order_root_ = NULL;
 
   node_counter_ = 0;
   lane_counter_ = 0;
-  std::vector<Node>* new_lane = new std::vector<Node>();
-  new_lane->reserve(10000);
-  node_lanes_.push_back(new_lane);
+  addLane();
 
   this->unsorted_node_ = NULL;
 
@@ -69,13 +73,46 @@ NodeContainer::NodeContainer(const NodeContainer &nc) {
     (*it)->set_second_child(node_mapping[(*it)->second_child()]);
   }
   unsorted_node_ = node_mapping[nc.unsorted_node_];
+#ifdef SCRM_BRANCH_INDEX
+  if (nc.has_branch_index()) enableBranchIndex();
+#endif
 }
 
 /*******************************************************
  * Management of Nodes
  *******************************************************/
 
+void NodeContainer::addLane() {
+  std::vector<Node>* new_lane = new std::vector<Node>();
+  new_lane->reserve(kLaneSize);
+  node_lanes_.push_back(new_lane);
+#ifdef SCRM_NODE_HANDLES
+  // The lane never reallocates, so its nodes can be addressed by handles.
+  lane_ids_.push_back(NodeArena::registerLane(new_lane->data()));
+  if (lane_ids_.back() >= lane_numbers_.size()) lane_numbers_.resize(lane_ids_.back() + 1, SIZE_MAX);
+  lane_numbers_[lane_ids_.back()] = lane_ids_.size() - 1;
+#endif
+}
+
 Node* NodeContainer::at(size_t nr) const {
+#ifdef SCRM_BRANCH_INDEX
+  // Use the sizes of the subtrees in the order index to find the node
+  if (order_index_) {
+    if (nr >= size_) throw std::out_of_range("NodeContainer out of range");
+    Node* current = order_root_;
+    while (true) {
+      assert( current != NULL );
+      size_t left_size = orderSize(current->order_left_);
+      if (nr == left_size) return current;
+      if (nr < left_size) current = Node::deref(current->order_left_);
+      else {
+        nr -= left_size + 1;
+        current = Node::deref(current->order_right_);
+      }
+    }
+  }
+#endif
+
   Node* current = first();
 
   for (size_t i=0; i < nr; ++i) {
@@ -93,6 +130,7 @@ void NodeContainer::push_back( Node* node ) {
     if ( this->first() == NULL ) {
         this->set_first( node );
         this->set_last( node );
+        indexInsert(node);
         return;
     }
     assert( this->first() != NULL );
@@ -102,6 +140,7 @@ void NodeContainer::push_back( Node* node ) {
     node->set_next(NULL);
     this->last()->set_next(node);
     this->set_last(node);
+    indexInsert(node);
     return;
 }
 
@@ -111,6 +150,7 @@ void NodeContainer::push_front( Node* node ) {
     if ( this->first() == NULL ) {
         this->set_first( node );
         this->set_last( node );
+        indexInsert(node);
         return;
     }
     assert( this->first() != NULL );
@@ -120,6 +160,7 @@ void NodeContainer::push_front( Node* node ) {
     node->set_previous(NULL);
     first()->set_previous(node);
     this->set_first(node);
+    indexInsert(node);
     return;
 }
 
@@ -134,6 +175,7 @@ void NodeContainer::add(Node* node, Node* after_node) {
   if (first() == NULL) {
     this->set_first(node);
     this->set_last(node);
+    indexInsert(node);
     return;
   }
   assert(first() != NULL);
@@ -144,6 +186,7 @@ void NodeContainer::add(Node* node, Node* after_node) {
     node->set_previous(NULL);
     first()->set_previous(node);
     this->set_first(node);
+    indexInsert(node);
     assert( this->sorted() );
     return;
   }
@@ -154,12 +197,22 @@ void NodeContainer::add(Node* node, Node* after_node) {
     node->set_next(NULL);
     last()->set_next(node);
     this->set_last(node);
+    indexInsert(node);
     assert( this->sorted() );
     return;
   }
 
   assert( after_node == NULL || node->height() >= after_node->height() );
 
+#ifdef SCRM_BRANCH_INDEX
+  // The order index finds the position without walking through the list
+  if (order_index_) {
+    this->add_before(node, orderFindHigher(node->height()));
+    indexInsert(node);
+    assert( this->sorted() );
+    return;
+  }
+#endif
 
   if (after_node == NULL) after_node = first();
   Node* current = after_node;
@@ -177,12 +230,14 @@ void NodeContainer::add(Node* node, Node* after_node) {
 
   // And add the node;
   this->add_before(node, current);
+  indexInsert(node);
   assert( this->sorted() );
 }
 
 
 void NodeContainer::remove(Node *node, const bool &del) {
   --size_;
+  indexErase(node);
   if ( node->is_first() && node->is_last() ) {
     this->set_first(NULL);
     this->set_last(NULL);
@@ -200,7 +255,7 @@ void NodeContainer::remove(Node *node, const bool &del) {
     node->next()->set_previous(node->previous());
   }
 
-  if (del) free_slots_.push(node);
+  if (del) free_slots_.push_back(node);
   assert( this->sorted() );
 }
 
@@ -214,6 +269,15 @@ void NodeContainer::move(Node *node, const double new_height) {
     return;
   }
 
+  // Nodes that stay between their neighbours keep their place in the list
+  // and the indices.
+  if ((node->is_first() || node->previous()->height() <= new_height) &&
+      (node->is_last() || new_height < node->next()->height())) {
+    node->set_height(new_height);
+    assert( this->sorted() );
+    return;
+  }
+
   // Remove from old place
   remove(node, false);
 
@@ -235,15 +299,18 @@ void NodeContainer::move(Node *node, const double new_height) {
 void NodeContainer::clear() {
   set_first(NULL);
   set_last(NULL);
+  branch_index_ = false;
+  index_roots_.clear();
+  order_index_ = false;
+  order_root_ = NULL;
   this->size_ = 0;
   this->node_counter_ = 0;
   this->lane_counter_ = 0;
 
-  // Clear free_slots_
-  std::stack<Node*>().swap(free_slots_);
-  
-  // Delete nodes
-  for (std::vector<Node>* lane : node_lanes_) lane->clear();
+  // The nodes are not deleted, but their slots are reused by createNode.
+  // This keeps the memory of the lanes and the free slots, such that
+  // simulating the next locus does not need to allocate memory again.
+  free_slots_.clear();
 }
 
 
@@ -258,10 +325,544 @@ void NodeContainer::add_before(Node* add, Node* next_node){
 
 
 
+/*******************************************************
+ * Branch index
+ *******************************************************/
+#ifdef SCRM_BRANCH_INDEX
+
+/**
+ * @brief Builds the branch index for the nodes in the container.
+ *
+ * From here on, the index is maintained when nodes are added, removed or
+ * moved, until the container is cleared.
+ */
+void NodeContainer::enableBranchIndex() {
+  branch_index_ = true;
+  index_roots_.clear();
+  for (NodeIterator it = iterator(); it.good(); ++it) (*it)->resetIndex();
+  for (NodeIterator it = iterator(); it.good(); ++it) branchInsert(*it, true);
+}
+
+
+// Changes the population of a node, which moves it into the treap of the
+// new population.
+void NodeContainer::set_population(Node* node, const size_t pop) {
+  if (!node->in_index() || node->population() == pop) {
+    node->set_population(pop);
+    return;
+  }
+  branchErase(node);
+  node->set_population(pop);
+  branchInsert(node);
+}
+
+
+/**
+ * @brief Finds the branches of a population that cross a time, using the
+ * branch index.
+ *
+ * Appends the nodes of population `pop` that are located before `node` in the
+ * container and whose parent is above `time` to `branches`, in the order of
+ * the container. This is equivalent to iterating over all nodes before `node`,
+ * but only visits O((k+1) log n) nodes of the population's treap for k
+ * branches found.
+ *
+ * @param node The node up to which we search for branches.
+ * @param time The time the branches should cross.
+ * @param pop The population of the branches.
+ * @param branches A vector to which the nodes below the branches are appended.
+ */
+void NodeContainer::findBranchesCrossing(Node const* node, const double time, const size_t pop,
+                                         std::vector<Node*> &branches) const {
+  assert( branch_index_ );
+  if (pop < index_roots_.size()) {
+    indexCollect(index_roots_[pop], node->height(), time, branches);
+  }
+
+  // Nodes with the same height as `node`, e.g. samples, are ordered by the
+  // list only.
+  size_t ties_start = branches.size();
+  for (Node* current = node->is_first() ? NULL : node->previous();
+       current != NULL && current->height() == node->height();
+       current = current->is_first() ? NULL : current->previous()) {
+    if (current->population() == pop && current->index_value() > time) {
+      branches.push_back(current);
+    }
+  }
+  std::reverse(branches.begin() + ties_start, branches.end());
+}
+
+
+// Appends the nodes of the subtree that are lower than `height` and whose
+// branch crosses `time` in order. Returns false once a node at `height` or
+// above is reached, as all nodes that follow in the index are higher, too.
+bool NodeContainer::indexCollect(Node* subtree, const double height, const double time,
+                                 std::vector<Node*> &branches) {
+  if (subtree == NULL || subtree->index_max_ <= time) return true;
+  if (!indexCollect(Node::deref(subtree->index_left_), height, time, branches)) return false;
+  if (subtree->height() >= height) return false;
+  if (subtree->index_value() > time) branches.push_back(subtree);
+  return indexCollect(Node::deref(subtree->index_right_), height, time, branches);
+}
+
+
+// Returns true if `node` is located before `other` in the container.
+bool NodeContainer::indexBefore(Node const* node, Node const* other) {
+  if (node->height() != other->height()) return node->height() < other->height();
+
+  // Nodes of equal height, e.g. samples, are ordered by their position in the
+  // list. Nodes are added behind all nodes of equal height, so that this is
+  // usually decided at the first step.
+  for (Node const* current = node; current != other; current = current->next()) {
+    if (current->is_last() || current->next()->height() != node->height()) return false;
+  }
+  return node != other;
+}
+
+
+// Inserts a node that was just added to the list into the indices
+void NodeContainer::indexInsert(Node* node) {
+  if (order_index_) orderInsert(node);
+  else if (size_ >= kOrderIndexMinNodes) enableOrderIndex();
+  branchInsert(node);
+}
+
+void NodeContainer::indexErase(Node* node) {
+  if (order_index_) orderErase(node);
+  branchErase(node);
+}
+
+
+// Inserts a node that was just added to the list into the treap of its
+// population. If `at_end` is set, the node is known to be behind all nodes
+// in the treap.
+void NodeContainer::branchInsert(Node* node, const bool at_end) {
+  if (!branch_index_) return;
+  assert( !node->in_index() );
+
+  // Derive a well mixed priority from a counter, so that the shape of the
+  // index does not depend on the random generator used for the simulation.
+  uint32_t priority = ++index_counter_;
+  priority ^= priority >> 16;
+  priority *= 0x7feb352d;
+  priority ^= priority >> 15;
+  priority *= 0x846ca68b;
+  priority ^= priority >> 16;
+  if (priority == 0) priority = 1;
+
+  node->resetIndex();
+  node->index_priority_ = priority;
+  node->index_max_ = node->index_value();
+
+  if (node->population() >= index_roots_.size()) {
+    index_roots_.resize(node->population() + 1, NULL);
+  }
+  Node* parent = index_roots_[node->population()];
+  if (parent == NULL) {
+    index_roots_[node->population()] = node;
+    return;
+  }
+
+  // Add the node as a leaf at its position in the list
+  while (true) {
+    if (!at_end && indexBefore(node, parent)) {
+      if (parent->index_left_ == kNullLink) {
+        parent->index_left_ = Node::link(node);
+        break;
+      }
+      parent = Node::deref(parent->index_left_);
+    } else {
+      if (parent->index_right_ == kNullLink) {
+        parent->index_right_ = Node::link(node);
+        break;
+      }
+      parent = Node::deref(parent->index_right_);
+    }
+  }
+  node->index_up_ = Node::link(parent);
+
+  // Restore the heap order of the priorities
+  while (node->index_up_ != kNullLink &&
+         Node::deref(node->index_up_)->index_priority_ < priority) {
+    indexRotateUp(node);
+  }
+  indexUpdatePath(Node::deref(node->index_up_));
+}
+
+
+void NodeContainer::branchErase(Node* node) {
+  if (!branch_index_) return;
+  assert( node->in_index() );
+
+  // Rotate the node down until it has at most one child
+  while (node->index_left_ != kNullLink && node->index_right_ != kNullLink) {
+    Node* left = Node::deref(node->index_left_);
+    Node* right = Node::deref(node->index_right_);
+    if (left->index_priority_ > right->index_priority_) indexRotateUp(left);
+    else indexRotateUp(right);
+  }
+
+  Node* child = Node::deref(node->index_left_ != kNullLink ? node->index_left_ : node->index_right_);
+  Node* parent = Node::deref(node->index_up_);
+  indexReplaceChild(parent, node, child);
+  node->resetIndex();
+  indexUpdatePath(parent);
+}
+
+
+// Rotates a node above its parent in the index.
+void NodeContainer::indexRotateUp(Node* node) {
+  Node* parent = Node::deref(node->index_up_);
+  assert( parent != NULL );
+  indexReplaceChild(Node::deref(parent->index_up_), parent, node);
+
+  if (parent->index_left_ == Node::link(node)) {
+    parent->index_left_ = node->index_right_;
+    if (node->index_right_ != kNullLink) {
+      Node::deref(node->index_right_)->index_up_ = Node::link(parent);
+    }
+    node->index_right_ = Node::link(parent);
+  } else {
+    assert( parent->index_right_ == Node::link(node) );
+    parent->index_right_ = node->index_left_;
+    if (node->index_left_ != kNullLink) {
+      Node::deref(node->index_left_)->index_up_ = Node::link(parent);
+    }
+    node->index_left_ = Node::link(parent);
+  }
+  parent->index_up_ = Node::link(node);
+
+  indexUpdate(parent);
+  indexUpdate(node);
+}
+
+
+// Replaces `old_child` of `parent` with `new_child` in the index, or the
+// root of the treap of its population if `parent` is NULL.
+void NodeContainer::indexReplaceChild(Node* parent, Node* old_child, Node* new_child) {
+  if (parent == NULL) index_roots_[old_child->population()] = new_child;
+  else if (parent->index_left_ == Node::link(old_child)) parent->index_left_ = Node::link(new_child);
+  else {
+    assert( parent->index_right_ == Node::link(old_child) );
+    parent->index_right_ = Node::link(new_child);
+  }
+  if (new_child != NULL) new_child->index_up_ = Node::link(parent);
+}
+
+
+// Recalculates the maximal parent height of a node's subtree
+void NodeContainer::indexUpdate(Node* node) {
+  double max = node->index_value();
+  if (node->index_left_ != kNullLink) max = std::max(max, Node::deref(node->index_left_)->index_max_);
+  if (node->index_right_ != kNullLink) max = std::max(max, Node::deref(node->index_right_)->index_max_);
+  node->index_max_ = max;
+}
+
+// Updates all nodes from `node` up to the root of the index.
+void NodeContainer::indexUpdatePath(Node* node) {
+  for (; node != NULL; node = Node::deref(node->index_up_)) indexUpdate(node);
+}
+
+
+
+/*******************************************************
+ * Order index
+ *******************************************************/
+
+/**
+ * @brief Builds the order index for the nodes in the container.
+ *
+ * The order index is a treap of all nodes in the order of the list, in which
+ * each node stores the size of its subtree. It allows to access nodes by
+ * position and to find the position of a new node in O(log n) steps. It is
+ * maintained until the container is cleared.
+ */
+void NodeContainer::enableOrderIndex() {
+  order_index_ = true;
+  order_root_ = NULL;
+  for (NodeIterator it = iterator(); it.good(); ++it) orderInsert(*it);
+}
+
+
+// Inserts a node that was just added to the list into the order index,
+// directly behind its predecessor in the list.
+void NodeContainer::orderInsert(Node* node) {
+  assert( order_index_ );
+  node->resetOrder();
+  node->order_size_ = 1;
+  if (order_root_ == NULL) {
+    order_root_ = node;
+    return;
+  }
+
+  Node* parent;
+  if (node->is_first()) {
+    parent = order_root_;
+    while (parent->order_left_ != kNullLink) parent = Node::deref(parent->order_left_);
+    parent->order_left_ = Node::link(node);
+  } else if (node->previous()->order_right_ == kNullLink) {
+    parent = node->previous();
+    parent->order_right_ = Node::link(node);
+  } else {
+    parent = Node::deref(node->previous()->order_right_);
+    while (parent->order_left_ != kNullLink) parent = Node::deref(parent->order_left_);
+    parent->order_left_ = Node::link(node);
+  }
+  node->order_up_ = Node::link(parent);
+  for (Node* current = parent; current != NULL; current = Node::deref(current->order_up_)) {
+    ++current->order_size_;
+  }
+
+  // Restore the heap order of the priorities
+  uint32_t priority = orderPriority(node);
+  while (node->order_up_ != kNullLink &&
+         orderPriority(Node::deref(node->order_up_)) < priority) {
+    orderRotateUp(node);
+  }
+}
+
+
+void NodeContainer::orderErase(Node* node) {
+  assert( node->order_size_ > 0 );
+
+  // Rotate the node down until it has at most one child
+  while (node->order_left_ != kNullLink && node->order_right_ != kNullLink) {
+    Node* left = Node::deref(node->order_left_);
+    Node* right = Node::deref(node->order_right_);
+    if (orderPriority(left) > orderPriority(right)) orderRotateUp(left);
+    else orderRotateUp(right);
+  }
+
+  Node* child = Node::deref(node->order_left_ != kNullLink ? node->order_left_ : node->order_right_);
+  Node* parent = Node::deref(node->order_up_);
+  orderReplaceChild(parent, node, child);
+  for (Node* current = parent; current != NULL; current = Node::deref(current->order_up_)) {
+    --current->order_size_;
+  }
+  node->resetOrder();
+}
+
+
+// Rotates a node above its parent in the order index.
+void NodeContainer::orderRotateUp(Node* node) {
+  Node* parent = Node::deref(node->order_up_);
+  assert( parent != NULL );
+  orderReplaceChild(Node::deref(parent->order_up_), parent, node);
+
+  if (parent->order_left_ == Node::link(node)) {
+    parent->order_left_ = node->order_right_;
+    if (node->order_right_ != kNullLink) {
+      Node::deref(node->order_right_)->order_up_ = Node::link(parent);
+    }
+    node->order_right_ = Node::link(parent);
+  } else {
+    assert( parent->order_right_ == Node::link(node) );
+    parent->order_right_ = node->order_left_;
+    if (node->order_left_ != kNullLink) {
+      Node::deref(node->order_left_)->order_up_ = Node::link(parent);
+    }
+    node->order_left_ = Node::link(parent);
+  }
+  parent->order_up_ = Node::link(node);
+
+  parent->order_size_ = 1 + orderSize(parent->order_left_) + orderSize(parent->order_right_);
+  node->order_size_ = 1 + orderSize(node->order_left_) + orderSize(node->order_right_);
+}
+
+
+// Replaces `old_child` of `parent` with `new_child` in the order index, or
+// its root if `parent` is NULL.
+void NodeContainer::orderReplaceChild(Node* parent, Node* old_child, Node* new_child) {
+  if (parent == NULL) order_root_ = new_child;
+  else if (parent->order_left_ == Node::link(old_child)) parent->order_left_ = Node::link(new_child);
+  else {
+    assert( parent->order_right_ == Node::link(old_child) );
+    parent->order_right_ = Node::link(new_child);
+  }
+  if (new_child != NULL) new_child->order_up_ = Node::link(parent);
+}
+
+
+// Returns the first node that is higher than `height`. A new node of this
+// height is added before it, behind all nodes of equal height.
+Node* NodeContainer::orderFindHigher(const double height) const {
+  Node* higher = NULL;
+  for (Node* current = order_root_; current != NULL; ) {
+    if (height < current->height()) {
+      higher = current;
+      current = Node::deref(current->order_left_);
+    } else {
+      current = Node::deref(current->order_right_);
+    }
+  }
+  assert( higher != NULL );
+  return higher;
+}
+
+
+// Derives a well mixed priority from the address of a node, which needs no
+// memory in the node and does not depend on the random generator.
+uint32_t NodeContainer::orderPriority(Node const* node) {
+  uint64_t key = reinterpret_cast<uintptr_t>(node);
+  key ^= key >> 33;
+  key *= 0xff51afd7ed558ccd;
+  key ^= key >> 33;
+  key *= 0xc4ceb9fe1a85ec53;
+  key ^= key >> 33;
+  return static_cast<uint32_t>(key);
+}
+#endif
+
+
+
 /*******************************************************
  * Consistency checking
  *******************************************************/
 
+#ifdef SCRM_BRANCH_INDEX
+bool NodeContainer::checkBranchIndex() const {
+  if (!checkOrderIndex()) return 0;
+
+  if (!branch_index_) {
+    for (ConstNodeIterator it = iterator(); it.good(); ++it) {
+      if ((*it)->in_index()) {
+        dout << "NodeContainer: Node " << *it << " is in the disabled branch index" << std::endl;
+        return 0;
+      }
+    }
+    return 1;
+  }
+
+  for (size_t pop = 0; pop < index_roots_.size(); ++pop) {
+    Node const* current = index_roots_[pop];
+    if (current == NULL) continue;
+    if (current->index_up_ != kNullLink) {
+      dout << "NodeContainer: Root of branch index has a parent" << std::endl;
+      return 0;
+    }
+    if (!checkBranchIndex(current)) return 0;
+
+    // The treap must contain the nodes of the population in the same order
+    // as the list
+    while (current->index_left_ != kNullLink) current = Node::deref(current->index_left_);
+    for (ConstNodeIterator it = iterator(); it.good(); ++it) {
+      if ((*it)->population() != pop) continue;
+      if (*it != current) {
+        dout << "NodeContainer: Branch index has wrong order at " << *it << std::endl;
+        return 0;
+      }
+      // Go to the next node in the treap
+      if (current->index_right_ != kNullLink) {
+        current = Node::deref(current->index_right_);
+        while (current->index_left_ != kNullLink) current = Node::deref(current->index_left_);
+      } else {
+        while (current->index_up_ != kNullLink &&
+               Node::deref(current->index_up_)->index_right_ == Node::link(current)) {
+          current = Node::deref(current->index_up_);
+        }
+        current = Node::deref(current->index_up_);
+      }
+    }
+    if (current != NULL) {
+      dout << "NodeContainer: Branch index contains additional nodes" << std::endl;
+      return 0;
+    }
+  }
+
+  for (ConstNodeIterator it = iterator(); it.good(); ++it) {
+    if (!(*it)->in_index()) {
+      dout << "NodeContainer: Node " << *it << " is missing in the branch index" << std::endl;
+      return 0;
+    }
+  }
+  return 1;
+}
+
+bool NodeContainer::checkBranchIndex(Node const* subtree) const {
+  double max = subtree->index_value();
+  for (NodeLink child_link : {subtree->index_left_, subtree->index_right_}) {
+    if (child_link == kNullLink) continue;
+    Node const* child = Node::deref(child_link);
+    if (child->index_up_ != Node::link(subtree)) {
+      dout << "NodeContainer: Wrong parent in branch index at " << child << std::endl;
+      return 0;
+    }
+    if (child->index_priority_ > subtree->index_priority_) {
+      dout << "NodeContainer: Wrong priorities in branch index at " << child << std::endl;
+      return 0;
+    }
+    if (!checkBranchIndex(child)) return 0;
+    if (child->population() != subtree->population()) {
+      dout << "NodeContainer: Wrong population in branch index at " << child << std::endl;
+      return 0;
+    }
+    max = std::max(max, child->index_max_);
+  }
+  if (max != subtree->index_max_) {
+    dout << "NodeContainer: Wrong maximum in branch index at " << subtree << std::endl;
+    return 0;
+  }
+  return 1;
+}
+
+bool NodeContainer::checkOrderIndex() const {
+  if (!order_index_) {
+    for (ConstNodeIterator it = iterator(); it.good(); ++it) {
+      if ((*it)->order_size_ != 0) {
+        dout << "NodeContainer: Node " << *it << " is in the disabled order index" << std::endl;
+        return 0;
+      }
+    }
+    return 1;
+  }
+
+  if (order_root_ == NULL) return size_ == 0;
+  if (order_root_->order_up_ != kNullLink) {
+    dout << "NodeContainer: Root of order index has a parent" << std::endl;
+    return 0;
+  }
+  if (order_root_->order_size_ != size_) {
+    dout << "NodeContainer: Order index has wrong size" << std::endl;
+    return 0;
+  }
+  if (!checkOrderIndex(order_root_)) return 0;
+
+  // The positions in the order index must match the list
+  size_t position = 0;
+  for (ConstNodeIterator it = iterator(); it.good(); ++it) {
+    if (at(position++) != *it) {
+      dout << "NodeContainer: Order index has wrong order at " << *it << std::endl;
+      return 0;
+    }
+  }
+  return 1;
+}
+
+bool NodeContainer::checkOrderIndex(Node const* subtree) const {
+  uint32_t size = 1;
+  for (NodeLink child_link : {subtree->order_left_, subtree->order_right_}) {
+    if (child_link == kNullLink) continue;
+    Node const* child = Node::deref(child_link);
+    if (child->order_up_ != Node::link(subtree)) {
+      dout << "NodeContainer: Wrong parent in order index at " << child << std::endl;
+      return 0;
+    }
+    if (orderPriority(child) > orderPriority(subtree)) {
+      dout << "NodeContainer: Wrong priorities in order index at " << child << std::endl;
+      return 0;
+    }
+    if (!checkOrderIndex(child)) return 0;
+    size += child->order_size_;
+  }
+  if (size != subtree->order_size_) {
+    dout << "NodeContainer: Wrong size in order index at " << subtree << std::endl;
+    return 0;
+  }
+  return 1;
+}
+#endif
+
+
 bool NodeContainer::sorted() const {
   Node* current = first();
   if ( !current->is_first() ) {
@@ -296,9 +897,18 @@ void swap(NodeContainer& first, NodeContainer& second) {
   swap(first.last_node_, second.last_node_);
   swap(first.size_, second.size_);
   swap(first.unsorted_node_, second.unsorted_node_);
+  swap(first.branch_index_, second.branch_index_);
+  swap(first.index_roots_, second.index_roots_);
+  swap(first.index_counter_, second.index_counter_);
+  swap(first.order_index_, second.order_index_);
+  swap(first.order_root_, second.order_root_);
   swap(first.node_counter_, second.node_counter_);
   swap(first.lane_counter_, second.lane_counter_);
   swap(first.node_lanes_, second.node_lanes_);
+#ifdef SCRM_NODE_HANDLES
+  swap(first.lane_ids_, second.lane_ids_);
+  swap(first.lane_numbers_, second.lane_numbers_);
+#endif
   swap(first.free_slots_, second.free_slots_);
 }
 
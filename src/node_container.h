@@ -26,7 +26,6 @@
 #include "macros.h" // Needs to be before cassert
 
 #include <vector>
-#include <stack>
 #include <stdexcept>
 #include <cfloat>
 #include <cassert>
@@ -47,6 +46,9 @@ class NodeContainer {
   ~NodeContainer() {
     clear();
     for (std::vector<Node>* lane : node_lanes_) delete lane;
+#ifdef SCRM_NODE_HANDLES
+    for (size_t lane_id : lane_ids_) NodeArena::releaseLane(lane_id);
+#endif
   };
 
   NodeContainer& operator=(NodeContainer nc) {
@@ -65,52 +67,40 @@ class NodeContainer {
 
   // Create Nodes
   Node* createNode(double height, size_t label = 0) {
-    // Use the slot of a previously deleted node if possible
-    if (free_slots_.size() > 0) {
-      Node* node = free_slots_.top();
-      free_slots_.pop();
-      *node = Node(height, label);
-      return node;
-    }
-
-    // Otherwise, use a new slot
-    if (node_counter_ >= 10000) {
-      ++lane_counter_;
-      node_counter_ = 0;
-      if (lane_counter_ == node_lanes_.size()) {
-        std::vector<Node>* new_lane = new std::vector<Node>();
-        new_lane->reserve(10000);
-        node_lanes_.push_back(new_lane);
-      }
-    }
-    ++node_counter_;
-    node_lanes_.at(lane_counter_)->push_back(Node(height, label));
-    return &*(node_lanes_.at(lane_counter_)->end() - 1);
+    return createNode(Node(height, label));
   }
 
-  // Create Nodes
   Node* createNode(const Node copiedNode) {
     // Use the slot of a previously deleted node if possible
     if (free_slots_.size() > 0) {
-      Node* node = free_slots_.top();
-      free_slots_.pop();
-      *node = Node(copiedNode);
-      return node;
+      Node* node = free_slots_.back();
+      free_slots_.pop_back();
+      return reuseSlot(node, copiedNode);
     }
 
-    // Otherwise, use a new slot
-    if (node_counter_ >= 10000) {
+    // Otherwise, use the next slot of the lanes. Slots that were used before
+    // the container was cleared are overwritten, and a lane only grows
+    // within its reserved memory when it is used for the first time.
+    if (node_counter_ >= kLaneSize) {
       ++lane_counter_;
       node_counter_ = 0;
-      if (lane_counter_ == node_lanes_.size()) {
-        std::vector<Node>* new_lane = new std::vector<Node>();
-        new_lane->reserve(10000);
-        node_lanes_.push_back(new_lane);
-      }
+      if (lane_counter_ == node_lanes_.size()) addLane();
+    }
+    std::vector<Node>* lane = node_lanes_[lane_counter_];
+    if (node_counter_ < lane->size()) {
+      return reuseSlot(&(*lane)[node_counter_++], copiedNode);
     }
+    lane->push_back(copiedNode);
+    Node* node = &lane->back();
+    node->resetIndex();
+    node->resetOrder();
+#ifdef SCRM_NODE_HANDLES
+    node->handle_ = NodeArena::handle(lane_ids_[lane_counter_], node_counter_);
+#else
+    node->slot_ = lane_counter_ * kLaneSize + node_counter_;
+#endif
     ++node_counter_;
-    node_lanes_.at(lane_counter_)->push_back(copiedNode);
-    return &*(node_lanes_.at(lane_counter_)->end() - 1);
+    return node;
   }
 
   void push_back(Node* node);
@@ -129,6 +119,50 @@ class NodeContainer {
   size_t size() const { return size_; };
   bool sorted() const;
 
+  // The position of a node in the lanes. It does not change while the node
+  // is stored in the container, and is reused for other nodes afterwards.
+  // With handles, it is derived from the lane and position of the handle.
+  size_t slot(Node const* node) const {
+#ifdef SCRM_NODE_HANDLES
+    size_t lane_id = node->handle_ >> NodeArena::kLaneBits;
+    size_t slot = lane_id < lane_numbers_.size() ?
+        lane_numbers_[lane_id] * kLaneSize + (node->handle_ & (kLaneSize - 1)) : SIZE_MAX;
+#else
+    size_t slot = node->slot_;
+#endif
+    if (slot / kLaneSize >= node_lanes_.size() ||
+        slot % kLaneSize >= node_lanes_[slot / kLaneSize]->size() ||
+        slotNode(slot) != node) {
+      throw std::out_of_range("Node is not stored in this NodeContainer");
+    }
+    return slot;
+  }
+
+  Node* slotNode(const size_t slot) const {
+    assert( slot / kLaneSize < node_lanes_.size() );
+    assert( slot % kLaneSize < node_lanes_[slot / kLaneSize]->size() );
+    return &(*node_lanes_[slot / kLaneSize])[slot % kLaneSize];
+  }
+
+#ifdef SCRM_BRANCH_INDEX
+  // The branch index is disabled after clearing the container
+  void enableBranchIndex();
+  bool has_branch_index() const { return branch_index_; }
+  void set_population(Node* node, const size_t pop);
+  bool checkBranchIndex() const;
+  void findBranchesCrossing(Node const* node, const double time, const size_t pop,
+                            std::vector<Node*> &branches) const;
+
+  // The order index is enabled once the container holds kOrderIndexMinNodes
+  // nodes, and disabled after clearing the container
+  bool has_order_index() const { return order_index_; }
+#else
+  bool has_branch_index() const { return false; }
+  bool has_order_index() const { return false; }
+  void set_population(Node* node, const size_t pop) { node->set_population(pop); }
+  bool checkBranchIndex() const { return true; }
+#endif
+
 #ifdef UNITTEST
   friend class TestNodeContainer;
 #endif
@@ -143,6 +177,47 @@ class NodeContainer {
 
   void add_before(Node* add, Node* next_node);
 
+  // Maintenance of the branch and order indices
+#ifdef SCRM_BRANCH_INDEX
+  void indexInsert(Node* node);
+  void indexErase(Node* node);
+  void branchInsert(Node* node, const bool at_end = false);
+  void branchErase(Node* node);
+  void indexRotateUp(Node* node);
+  void indexReplaceChild(Node* parent, Node* old_child, Node* new_child);
+  static bool indexBefore(Node const* node, Node const* other);
+  static void indexUpdate(Node* node);
+  static void indexUpdatePath(Node* node);
+  static bool indexCollect(Node* subtree, const double height, const double time,
+                           std::vector<Node*> &branches);
+  bool checkBranchIndex(Node const* subtree) const;
+
+  void enableOrderIndex();
+  void orderInsert(Node* node);
+  void orderErase(Node* node);
+  void orderRotateUp(Node* node);
+  void orderReplaceChild(Node* parent, Node* old_child, Node* new_child);
+  Node* orderFindHigher(const double height) const;
+  static uint32_t orderPriority(Node const* node);
+  static uint32_t orderSize(const NodeLink link) {
+    return link == kNullLink ? 0 : Node::deref(link)->order_size_;
+  }
+  bool checkOrderIndex() const;
+  bool checkOrderIndex(Node const* subtree) const;
+
+  // Below this number of nodes, walking through the list is fast enough
+  static const size_t kOrderIndexMinNodes = 10000;
+#else
+  void indexInsert(Node*) { }
+  void indexErase(Node*) { }
+#endif
+
+  bool branch_index_;              // If the branch index is enabled
+  std::vector<Node*> index_roots_; // The root of the treap of each population
+  uint32_t index_counter_;
+  bool order_index_;               // If the order index is enabled
+  Node* order_root_;               // The root of the order index
+
   Node* first_node_;
   Node* last_node_;
 
@@ -152,9 +227,32 @@ class NodeContainer {
   Node* unsorted_node_;
   size_t size_;
 
-  // Storing the nodes in lanes a 10k nodes
+  // Storing the nodes in lanes a 10k nodes, or in lanes of the NodeArena
+  // when nodes are addressed by handles.
+#ifdef SCRM_NODE_HANDLES
+  static const size_t kLaneSize = NodeArena::kLaneSize;
+  std::vector<size_t> lane_ids_;      // The id of each lane in the NodeArena
+  std::vector<size_t> lane_numbers_;  // The number of the lane with each id
+#else
+  static const size_t kLaneSize = 10000;
+#endif
+  void addLane();
+  Node* reuseSlot(Node* node, const Node &copiedNode) {
+#ifdef SCRM_NODE_HANDLES
+    NodeLink handle = node->handle_;
+    *node = copiedNode;
+    node->handle_ = handle;
+#else
+    NodeCount slot = node->slot_;
+    *node = copiedNode;
+    node->slot_ = slot;
+#endif
+    node->resetIndex();
+    node->resetOrder();
+    return node;
+  }
   std::vector<std::vector<Node>*> node_lanes_;
-  std::stack<Node*> free_slots_;
+  std::vector<Node*> free_slots_;
   size_t node_counter_;
   size_t lane_counter_;
 };
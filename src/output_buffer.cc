@@ -0,0 +1,87 @@
+/*
+ * scrm is an implementation of the Sequential-Coalescent-with-Recombination Model.
+ * 
+ * Copyright (C) 2013, 2014 Paul R. Staab, Sha (Joe) Zhu, Dirk Metzler and Gerton Lunter
+ * 
+ * This file is part of scrm.
+ * 
+ * scrm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "output_buffer.h"
+
+#include <cmath>
+#include <cstdio>
+
+// std::to_chars for floating point numbers is available in C++17 with
+// recent standard libraries only
+#if defined(__has_include) && __cplusplus >= 201703L
+#if __has_include(<charconv>)
+#include <charconv>
+#endif
+#endif
+
+void OutputBuffer::formatInteger(std::string &str, size_t value) {
+  char digits[24];
+  char *pos = digits + sizeof(digits);
+  do {
+    *--pos = '0' + value % 10;
+    value /= 10;
+  } while (value > 0);
+  str.append(pos, digits + sizeof(digits) - pos);
+}
+
+
+/**
+ * @brief Appends a floating point number to a string.
+ *
+ * The result is identical to printing the number to a std::ostream with 
+ * the given precision and the default float field, which uses the "%g"
+ * format of printf. Integral values that have less digits than the
+ * precision are printed without a decimal point by "%g", which is done
+ * here without calling snprintf. Other values are formatted with
+ * std::to_chars, which gives the same result as "%g" without parsing a
+ * format string or consulting the locale, and with snprintf if it is not
+ * available or the number does not fit into 64 characters.
+ */
+void OutputBuffer::formatDouble(std::string &str, const double value, const int precision) {
+  static const double max_integer[] = { 1e1, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8,
+                                        1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15 };
+  if (std::fabs(value) < max_integer[precision < 15 ? (precision > 0 ? precision : 0) : 15] &&
+      value == std::floor(value) && !(value == 0.0 && std::signbit(value))) {
+    if (value < 0) str.push_back('-');
+    formatInteger(str, (size_t)std::fabs(value));
+    return;
+  }
+
+  char number[64];
+#ifdef __cpp_lib_to_chars
+  std::to_chars_result result = std::to_chars(number, number + sizeof(number), value,
+                                              std::chars_format::general, precision);
+  if (result.ec == std::errc()) {
+    str.append(number, result.ptr - number);
+    return;
+  }
+#endif
+
+  int length = snprintf(number, sizeof(number), "%.*g", precision, value);
+  if (length < (int)sizeof(number)) {
+    str.append(number, length);
+  } else {
+    std::vector<char> long_number(length + 1);
+    snprintf(long_number.data(), long_number.size(), "%.*g", precision, value);
+    str.append(long_number.data(), length);
+  }
+}
@@ -0,0 +1,114 @@
+/*
+ * scrm is an implementation of the Sequential-Coalescent-with-Recombination Model.
+ * 
+ * Copyright (C) 2013, 2014 Paul R. Staab, Sha (Joe) Zhu, Dirk Metzler and Gerton Lunter
+ * 
+ * This file is part of scrm.
+ * 
+ * scrm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef scrm_src_output_buffer
+#define scrm_src_output_buffer
+
+#include <cstddef>
+#include <cstring>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Buffers the output of the summary statistics.
+ *
+ * The output is collected in a large string buffer that is written to the
+ * underlying stream only when it is full or when flush() is called, which
+ * scrm does once per locus. Numbers are formatted directly into the buffer.
+ * Floating point numbers are printed with the given precision and are
+ * formatted exactly like std::ostream does it with the default float field.
+ */
+class OutputBuffer {
+ public:
+  explicit OutputBuffer(std::ostream &output, const size_t capacity = 1 << 20) :
+    output_(output), capacity_(capacity), precision_(output.precision()) {
+    buffer_.reserve(capacity + 1024);
+  }
+  ~OutputBuffer() { flush(); }
+
+  OutputBuffer& operator<<(const char* str) { 
+    buffer_.append(str, strlen(str));
+    return write();
+  }
+  OutputBuffer& write(const void* data, const size_t length) { 
+    buffer_.append(static_cast<const char*>(data), length);
+    return write();
+  }
+  OutputBuffer& operator<<(const std::string &str) { 
+    buffer_.append(str);
+    return write();
+  }
+  OutputBuffer& operator<<(const char c) { 
+    buffer_.push_back(c);
+    return write();
+  }
+  OutputBuffer& operator<<(const size_t value) { 
+    formatInteger(buffer_, value);
+    return write();
+  }
+  OutputBuffer& operator<<(const int value) { 
+    if (value < 0) buffer_.push_back('-');
+    formatInteger(buffer_, value < 0 ? (size_t)(-(long long)value) : (size_t)value);
+    return write();
+  }
+  OutputBuffer& operator<<(const double value) { 
+    formatDouble(buffer_, value, precision_);
+    return write();
+  }
+
+  // Prints the elements of a vector, each followed by a space.
+  template <typename T>
+  OutputBuffer& operator<<(const std::vector<T> &vec) {
+    for (const T &value : vec) *this << value << ' ';
+    return *this;
+  }
+
+  // Writes the buffered output to the stream and flushes it.
+  void flush() {
+    output_.write(buffer_.data(), buffer_.size());
+    output_.flush();
+    buffer_.clear();
+  }
+
+  int precision() const { return precision_; }
+  void set_precision(const int precision) { precision_ = precision; }
+
+  static void formatInteger(std::string &str, size_t value);
+  static void formatDouble(std::string &str, const double value, const int precision);
+
+ private:
+  OutputBuffer& write() {
+    if (buffer_.size() >= capacity_) {
+      output_.write(buffer_.data(), buffer_.size());
+      buffer_.clear();
+    }
+    return *this;
+  }
+
+  std::ostream &output_;
+  std::string buffer_;
+  size_t capacity_;
+  int precision_;
+};
+
+#endif
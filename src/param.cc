@@ -51,7 +51,17 @@ Model Param::parse() {
        newick_trees = false,
        orientedForest = false,
        sfs = false,
-       transpose = false;
+       transpose = false,
+       binary = false,
+       tree_sequence = false,
+       incremental_forest = false,
+       pi = false,
+       theta_w = false,
+       tajimas_d = false,
+       normalized_sfs = false,
+       print_rows = false,
+       print_means = false,
+       branch_sfs = false;
 
   // Tracks if demographic where added to the model.
   // After the first demographic feature, defining substructure is no longer allowed.
@@ -347,6 +357,11 @@ Model Param::parse() {
       orientedForest = true;
     }
 
+    else if (*argv_i == "-Odiff"){
+      orientedForest = true;
+      incremental_forest = true;
+    }
+
     else if (*argv_i == "-SC" || *argv_i == "--SC") {
       if (++argv_i == argv_.end()) throw std::invalid_argument("Missing sequence scaling argument.");
 
@@ -367,6 +382,38 @@ Model Param::parse() {
       sfs = true;
     }
 
+    else if (*argv_i == "-oTS") {
+      tree_sequence = true;
+    }
+
+    else if (*argv_i == "-oBSFS") {
+      branch_sfs = true;
+    }
+
+    else if (*argv_i == "-oPi") {
+      pi = true;
+    }
+
+    else if (*argv_i == "-oThetaW") {
+      theta_w = true;
+    }
+
+    else if (*argv_i == "-oTajD") {
+      tajimas_d = true;
+    }
+
+    else if (*argv_i == "-oNSFS") {
+      normalized_sfs = true;
+    }
+
+    else if (*argv_i == "-oRow") {
+      print_rows = true;
+    }
+
+    else if (*argv_i == "-oMeans") {
+      print_means = true;
+    }
+
     else if (*argv_i == "-p") {
       this->precision_ = readNextInt() ;
     }
@@ -411,10 +458,58 @@ Model Param::parse() {
       this->set_print_model(true);
     }
 
+    else if (*argv_i == "-threads" || *argv_i == "--threads") {
+      this->set_threads(readNextInt());
+      if (threads() == 0) throw std::invalid_argument("Number of threads must be at least one.");
+      this->set_streams(true);
+    }
+
+    else if (*argv_i == "-rng" || *argv_i == "--rng") {
+      if (++argv_i == argv_.end()) throw std::invalid_argument("Missing random generator argument.");
+
+      if (*argv_i == "mt") set_random_generator(mersenne_twister);
+      else if (*argv_i == "xoshiro") set_random_generator(xoshiro256);
+      else if (*argv_i == "philox") set_random_generator(philox4x32);
+      else throw 
+        std::invalid_argument(std::string("Unknown random generator: ") +
+                              *argv_i +
+                              std::string(". Valid are 'mt', 'xoshiro' or 'philox'."));
+    }
+
+    else if (*argv_i == "-streams" || *argv_i == "--streams") {
+      this->set_streams(true);
+    }
+
+    else if (*argv_i == "-stats" || *argv_i == "--stats") {
+#ifdef SCRM_STATS
+      this->set_print_stats(true);
+#else
+      throw std::invalid_argument("scrm was compiled without performance counters. Configure it with --enable-stats to use -stats.");
+#endif
+    }
+
+    else if (*argv_i == "-first-locus" || *argv_i == "--first-locus") {
+      size_t first_locus = readNextInt();
+      if (first_locus == 0) throw std::invalid_argument("Loci are numbered starting with one.");
+      this->set_first_locus(first_locus - 1);
+      this->set_streams(true);
+    }
+
     else if (*argv_i == "-transpose-segsites" || *argv_i == "--transpose-segsites") {
       transpose = true;
     }
 
+    else if (*argv_i == "-o" || *argv_i == "--o") {
+      if (++argv_i == argv_.end()) throw std::invalid_argument("Missing output format argument.");
+
+      if (*argv_i == "ms") binary = false;
+      else if (*argv_i == "bin") binary = true;
+      else throw 
+        std::invalid_argument(std::string("Unknown output format: ") +
+                              *argv_i +
+                              std::string(". Valid are 'ms' or 'bin'."));
+    }
+
 
     // ------------------------------------------------------------------
     // Unsupported ms arguments
@@ -442,21 +537,62 @@ Model Param::parse() {
     throw std::invalid_argument("Sum of samples not equal to the total sample size");
   }
 
+  // Print only a table of SFS based statistics
+  if (print_rows || print_means) {
+    if (seg_sites == NULL) 
+      throw std::invalid_argument("You need to give a mutation rate ('-t') to use '-oRow' or '-oMeans'"); 
+    if (newick_trees || orientedForest || tmrca || sfs || branch_sfs || tree_sequence || transpose || binary) 
+      throw std::invalid_argument("'-oRow' and '-oMeans' can only be combined with '-oPi', '-oThetaW', '-oTajD' and '-oNSFS'"); 
+    if (print_means && threads() > 0) 
+      throw std::invalid_argument("scrm does not support '-oMeans' and '-threads' at the same time"); 
+    if (!(pi || theta_w || tajimas_d || normalized_sfs)) pi = theta_w = tajimas_d = true;
+
+    // The haplotypes are not needed for the table.
+    seg_sites->set_store_haplotypes(false);
+    auto frequency_spectrum = std::make_shared<FrequencySpectrum>(seg_sites, model);
+    auto table = std::make_shared<StatisticsTable>(frequency_spectrum, print_rows, print_means);
+    if (pi) table->addStatistic(std::make_shared<NucleotideDiversity>(frequency_spectrum));
+    if (theta_w) table->addStatistic(std::make_shared<WattersonsTheta>(frequency_spectrum));
+    if (tajimas_d) table->addStatistic(std::make_shared<TajimasD>(frequency_spectrum));
+    if (normalized_sfs) table->addStatistic(std::make_shared<NormalizedSFS>(frequency_spectrum));
+    model.addSummaryStatistic(table);
+    this->set_compact_output(true);
+
+    model.finalize();
+    return model;
+  }
+
   // Add summary statistics in order of their output
   if (newick_trees) model.addSummaryStatistic(std::make_shared<NewickTree>(this->precision(), 
                                                                            model.has_recombination()));
   if (orientedForest) {
     if (newick_trees) throw std::invalid_argument("scrm does not support '-T' and '-O' at the same time"); 
-    model.addSummaryStatistic(std::make_shared<OrientedForest>(model.sample_size()));
+    model.addSummaryStatistic(std::make_shared<OrientedForest>(model.sample_size(),
+                                                               incremental_forest));
   }
   if (tmrca) model.addSummaryStatistic(std::make_shared<TMRCA>());
   if (seg_sites.get() != NULL) model.addSummaryStatistic(seg_sites);
   if (seg_sites.get() != NULL && transpose ) seg_sites->set_transpose(true);
-  if (sfs) {
+  if (binary) {
+    if (seg_sites == NULL) 
+      throw std::invalid_argument("You need to give a mutation rate ('-t') to use binary output"); 
+    if (transpose) 
+      throw std::invalid_argument("scrm does not support '-o bin' and '-transpose-segsites' at the same time"); 
+    seg_sites->set_binary(true);
+  }
+  std::shared_ptr<FrequencySpectrum> frequency_spectrum;
+  if (sfs || pi || theta_w || tajimas_d || normalized_sfs) {
     if (seg_sites == NULL) 
       throw std::invalid_argument("You need to give a mutation rate ('-t') to simulate a SFS"); 
-    model.addSummaryStatistic(std::make_shared<FrequencySpectrum>(seg_sites, model));
+    frequency_spectrum = std::make_shared<FrequencySpectrum>(seg_sites, model);
   }
+  if (sfs) model.addSummaryStatistic(frequency_spectrum);
+  if (pi) model.addSummaryStatistic(std::make_shared<NucleotideDiversity>(frequency_spectrum));
+  if (theta_w) model.addSummaryStatistic(std::make_shared<WattersonsTheta>(frequency_spectrum));
+  if (tajimas_d) model.addSummaryStatistic(std::make_shared<TajimasD>(frequency_spectrum));
+  if (normalized_sfs) model.addSummaryStatistic(std::make_shared<NormalizedSFS>(frequency_spectrum));
+  if (branch_sfs) model.addSummaryStatistic(std::make_shared<BranchFrequencySpectrum>(model.sample_size()));
+  if (tree_sequence) model.addSummaryStatistic(std::make_shared<TreeSequence>());
 
   model.finalize();
   return model;
@@ -522,8 +658,24 @@ void Param::printHelp(std::ostream& out) {
       << "                   neutral mutation rate per locus." << std::endl;
   out << "  -T               Print the simulated local genealogies in Newick format." << std::endl;
   out << "  -O               Print the simulated local genealogies in Oriented Forest format." << std::endl;
+  out << "  -Odiff           As -O, but print only the entries that changed compared to" << std::endl
+      << "                   the previous genealogy after the first one of each locus." << std::endl;
   out << "  -L               Print the TMRCA and the local tree length for each segment." << std::endl;
   out << "  -oSFS            Print the Site Frequency Spectrum for each locus." << std::endl;
+  out << "  -oBSFS           Print the SFS in terms of branch lengths for each locus." << std::endl
+      << "                   Does not require to simulate mutations." << std::endl;
+  out << "  -oPi, -oThetaW, -oTajD, -oNSFS" << std::endl
+      << "                   Print pi, Watterson's theta, Tajima's D or the normalized" << std::endl
+      << "                   SFS for each locus." << std::endl;
+  out << "  -oRow            Print only the number of segregating sites and the" << std::endl
+      << "                   statistics above as one row per locus." << std::endl;
+  out << "  -oMeans          Print the mean and variance of these statistics across" << std::endl
+      << "                   all loci at the end." << std::endl;
+  out << "  -oTS             Print the genealogies of each locus as tree sequence, using" << std::endl
+      << "                   a table of nodes and a table of edges." << std::endl;
+  out << "  -o <ms|bin>      Print the segregating sites as text like ms (default) or in" << std::endl
+      << "                   a compact binary format (bin). Use tools/scrm_bin2ms to" << std::endl
+      << "                   convert the binary format to text." << std::endl;
   out << "  -SC [ms|rel|abs] Scaling of sequence positions. Either" << std::endl 
       << "                   relative (rel) to the locus length between 0 and 1," << std::endl 
       << "                   absolute (abs) in base pairs or as in ms (default)." << std::endl;
@@ -535,6 +687,21 @@ void Param::printHelp(std::ostream& out) {
       << "                   integer numbers." << std::endl;
   out << "  -p <digits>      Specify the number of significant digits used in the output." << std::endl
       << "                   Defaults to 6." << std::endl;
+  out << "  -rng <mt|xoshiro|philox>   The random generator to use: the Mersenne" << std::endl
+      << "                   Twister (mt, default), xoshiro256** (xoshiro) or the" << std::endl
+      << "                   counter-based Philox4x32-10 (philox), which has a" << std::endl
+      << "                   period of 2^64 blocks of four words per stream." << std::endl;
+  out << "  -streams         Use an independent random stream for each locus, which" << std::endl
+      << "                   depends only on the seed and the number of the locus." << std::endl;
+  out << "  -first-locus <i> Start with locus number i. Together with the seed of a" << std::endl
+      << "                   previous run, this reproduces its i-th locus. Implies -streams." << std::endl;
+  out << "  -threads <N>     Simulate the loci in parallel using N threads. Implies" << std::endl
+      << "                   -streams, so that the output does not depend on N. It is" << std::endl
+      << "                   identical to a serial run with -streams, but differs from" << std::endl
+      << "                   the default serial output for the same seed." << std::endl;
+  out << "  -stats           Print performance counters and the time spent in each phase" << std::endl
+      << "                   of the simulation to stderr in JSON format. Requires scrm to" << std::endl
+      << "                   be configured with --enable-stats." << std::endl;
   out << "  -v, --version    Prints the version of scrm." << std::endl;
   out << "  -h, --help       Prints this text." << std::endl;
   out << "  -print-model,    " << std::endl
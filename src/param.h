@@ -40,6 +40,11 @@
 #include "summary_statistics/frequency_spectrum.h"
 #include "summary_statistics/newick_tree.h"
 #include "summary_statistics/oriented_forest.h"
+#include "summary_statistics/tree_sequence.h"
+#include "summary_statistics/sfs_statistics.h"
+#include "summary_statistics/statistics_table.h"
+#include "summary_statistics/branch_frequency_spectrum.h"
+#include "random/random_generator.h"
 
 class Param {
  public:
@@ -72,6 +77,12 @@ class Param {
     this->set_version(false);
     this->set_precision(6);
     this->set_print_model(false);
+    this->set_threads(0);
+    this->set_streams(false);
+    this->set_print_stats(false);
+    this->set_first_locus(0);
+    this->set_compact_output(false);
+    this->set_random_generator(mersenne_twister);
     this->argv_i = argv_.begin();
   }
 
@@ -83,6 +94,12 @@ class Param {
   size_t precision() const { return precision_; }
   bool seed_is_set() const { return this->seed_set_; }
   bool print_model() const { return this->print_model_; }
+  size_t threads() const { return this->threads_; }
+  bool streams() const { return this->streams_; }
+  bool print_stats() const { return this->print_stats_; }
+  size_t first_locus() const { return this->first_locus_; }
+  bool compact_output() const { return this->compact_output_; }
+  GeneratorType random_generator() const { return this->random_generator_; }
 
   void set_precision ( const size_t p ) { this->precision_ = p; }
   void set_random_seed(const size_t seed) { 
@@ -90,6 +107,12 @@ class Param {
     this->seed_set_ = true; 
   }
   void set_print_model(const bool print_model) { print_model_ = print_model; }
+  void set_threads(const size_t threads) { threads_ = threads; }
+  void set_streams(const bool streams) { streams_ = streams; }
+  void set_print_stats(const bool print_stats) { print_stats_ = print_stats; }
+  void set_first_locus(const size_t first_locus) { first_locus_ = first_locus; }
+  void set_compact_output(const bool compact) { compact_output_ = compact; }
+  void set_random_generator(const GeneratorType type) { random_generator_ = type; }
 
   // Other methods
   void printHelp(std::ostream& stream);
@@ -137,10 +160,16 @@ class Param {
   size_t seed_set_;
   size_t random_seed_;
   size_t precision_;
+  size_t threads_;
+  size_t first_locus_;
+  bool streams_;
+  bool print_stats_;
+  GeneratorType random_generator_;
   bool directly_called_;
   bool help_;
   bool version_;
   bool read_init_genealogy_;
   bool print_model_;
+  bool compact_output_;
 };
 #endif
@@ -26,5 +26,7 @@ ConstantGenerator::ConstantGenerator() {}
 ConstantGenerator::ConstantGenerator(int seed) { (void)seed; }
 ConstantGenerator::~ConstantGenerator(){}
 
-double ConstantGenerator::sample() { return(0.5); }
+void ConstantGenerator::sampleUniforms(double* uniforms, const size_t number) {
+  for (size_t i = 0; i < number; ++i) uniforms[i] = 0.5;
+}
 void ConstantGenerator::initialize() {}
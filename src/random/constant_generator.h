@@ -37,8 +37,10 @@ class ConstantGenerator : public RandomGenerator
    ConstantGenerator(int seed);
    virtual ~ConstantGenerator();
 
-   virtual double sample();
    void initialize();
+
+  protected:
+   virtual void sampleUniforms(double* uniforms, const size_t number);
 };
 
 #endif
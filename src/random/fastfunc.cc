@@ -47,3 +47,50 @@ void FastFunc::build_fastlog_double_table(int size) {
     prevy = targety;
   }
 }
+
+/**
+ * @brief Calculates the natural logarithms of a block of numbers.
+ *
+ * Each number is split into 2^k * z with z in [sqrt(2)/2, sqrt(2)), and
+ * log(z) is approximated by the minimax polynomial of fdlibm's log in
+ * s = (z-1)/(z+1). The split only uses integer operations on the bits of the
+ * numbers, and the exponent k is converted to a double by placing it in the
+ * mantissa of 2^52, which works with the vector instructions of SSE2.
+ *
+ * The values must be positive and normal, or zero, for which a finite value
+ * around -709 is returned.
+ */
+void FastFunc::blocklog(const double* values, double* logs, const size_t number) {
+  const uint64_t offset = 0x3fe6a09e667f3bcd;         // sqrt(2)/2
+  const uint64_t bias = (uint64_t)1024 << 52;         // keeps the exponent positive
+  const uint64_t exponent_mask = (uint64_t)0xfff << 52;
+  const double ln2_hi = 6.93147180369123816490e-01, ln2_lo = 1.90821492927058770002e-10;
+  const double lg1 = 6.666666666666735130e-01, lg2 = 3.999999999940941908e-01,
+               lg3 = 2.857142874366239149e-01, lg4 = 2.222219843214978396e-01,
+               lg5 = 1.818357216161805012e-01, lg6 = 1.531383769920937332e-01,
+               lg7 = 1.479819860511658591e-01;
+
+  for (size_t i = 0; i < number; ++i) {
+    uint64_t bits;
+    std::memcpy(&bits, values + i, sizeof(double));
+
+    // Split the number into 2^k * z
+    uint64_t shifted = bits - offset + bias;
+    uint64_t z_bits = bits - ((shifted & exponent_mask) - bias);
+    uint64_t k_bits = (shifted >> 52) | 0x4330000000000000;  // 2^52 + k + 1024
+    double k, z;
+    std::memcpy(&k, &k_bits, sizeof(double));
+    std::memcpy(&z, &z_bits, sizeof(double));
+    k -= 4503599627370496.0 + 1024.0;
+
+    // log(z) = f - f^2/2 + s * (f^2/2 + R(s^2))
+    double f = z - 1.0;
+    double hfsq = 0.5 * f * f;
+    double s = f / (2.0 + f);
+    double s2 = s * s;
+    double s4 = s2 * s2;
+    double r = s2 * (lg1 + s4 * (lg3 + s4 * (lg5 + s4 * lg7))) +
+               s4 * (lg2 + s4 * (lg4 + s4 * lg6));
+    logs[i] = k * ln2_hi - ((hfsq - (s * (hfsq + r) + k * ln2_lo)) - f);
+  }
+}
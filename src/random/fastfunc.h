@@ -27,6 +27,7 @@
 #include <cstdint>
 #include <cmath>
 #include <vector>
+#include <cstring>
 
 #if !defined(__APPLE__)
 #include <malloc.h>
@@ -47,6 +48,11 @@ class FastFunc {
   double fastexp_up(double y);  /* upper bound to exp; at most 6.148% too high.  10x as fast as exp */
   double fastexp_lo(double y);  /* lower bound to exp; at most 5.792% too low.  10x as fast as exp */
 
+  // Natural logarithms of a block of positive numbers, with an error of about
+  // one ulp. Unlike fastlog, this uses no table lookups and no branches, so
+  // that the compiler can vectorize the loop over the block.
+  static void blocklog(const double* values, double* logs, const size_t number);
+
  private:
   void build_fastlog_double_table(int);
   
@@ -22,8 +22,9 @@
 
 #include "mersenne_twister.h"
 
+#include <algorithm>
+
 void MersenneTwister::construct_common(const size_t seed){
-  unif_ = std::uniform_real_distribution<>(0, 1);
   this->set_seed(seed);
 }
 
@@ -40,22 +41,105 @@ MersenneTwister::MersenneTwister(const bool use_seed, size_t seed){
   this->construct_common(seed);
 }
 
+// Initializes the state as std::mt19937_64(seed) does.
+void MersenneTwister::set_seed(const size_t seed) {
+  RandomGenerator::set_seed(seed);
+  state_[0] = seed;
+  for (size_t i = 1; i < kStateSize; ++i) {
+    state_[i] = 6364136223846793005ULL * (state_[i-1] ^ (state_[i-1] >> 62)) + i;
+  }
+  state_position_ = kStateSize;
+  this->initializeUnitExponential();
+}
 
 /**
- * @brief Generates a random seed using entropy provided by the operating
- * system. 
+ * @brief Re-initializes the generator with the random stream number 'stream'.
+ *
+ * The complete state of the generator is initialized from the seed and the
+ * stream number using a seed sequence. This gives streams that are
+ * independent for practical purposes and can be restored from (seed, stream)
+ * alone, without replaying the numbers drawn from other streams.
  *
- * @return A random int between 0 and 2^32
+ * @param stream The number of the stream, e.g. the number of a locus.
  */
-size_t MersenneTwister::generateRandomSeed() const {
-  std::random_device rd;
-  std::uniform_int_distribution<size_t> dist(0, 4294967295); // 0 - 2^32-1
-  return(dist(rd));
-}
+void MersenneTwister::set_stream(const size_t stream) {
+  std::seed_seq seed_sequence{ static_cast<uint32_t>(seed()),
+                               static_cast<uint32_t>((uint64_t)seed() >> 32),
+                               static_cast<uint32_t>(stream),
+                               static_cast<uint32_t>((uint64_t)stream >> 32) };
 
-void MersenneTwister::set_seed(const size_t seed) {
-  RandomGenerator::set_seed(seed);
-  mt_ = std::mt19937_64(seed);
+  // Fill the state with pairs of 32-bit words of the sequence, as
+  // std::mt19937_64::seed(seed_sequence) does.
+  uint32_t words[2 * kStateSize];
+  seed_sequence.generate(words, words + 2 * kStateSize);
+  bool zero = true;
+  for (size_t i = 0; i < kStateSize; ++i) {
+    state_[i] = words[2*i] | ((uint64_t)words[2*i+1] << 32);
+    if (i == 0) zero = (state_[0] >> 31) == 0;
+    else zero = zero && state_[i] == 0;
+  }
+  if (zero) state_[0] = (uint64_t)1 << 63;
+  state_position_ = kStateSize;
+  this->discardBuffer();
   this->initializeUnitExponential();
 }
 
+// Generates the next 312 words of the state. The first loop only reads words
+// that are replaced later, and the second one words that were replaced at
+// least 156 steps before, so both can be vectorized.
+void MersenneTwister::twist() {
+  const size_t shift = 156;
+  const uint64_t upper_mask = ~(uint64_t)0 << 31;
+  const uint64_t lower_mask = ~upper_mask;
+  const uint64_t matrix = 0xb5026f5aa96619e9;
+
+  for (size_t i = 0; i < kStateSize - shift; ++i) {
+    uint64_t y = (state_[i] & upper_mask) | (state_[i+1] & lower_mask);
+    state_[i] = state_[i+shift] ^ (y >> 1) ^ ((state_[i+1] & 1) * matrix);
+  }
+  for (size_t i = kStateSize - shift; i < kStateSize - 1; ++i) {
+    uint64_t y = (state_[i] & upper_mask) | (state_[i+1] & lower_mask);
+    state_[i] = state_[i+shift-kStateSize] ^ (y >> 1) ^ ((state_[i+1] & 1) * matrix);
+  }
+  uint64_t y = (state_[kStateSize-1] & upper_mask) | (state_[0] & lower_mask);
+  state_[kStateSize-1] = state_[shift-1] ^ (y >> 1) ^ ((state_[0] & 1) * matrix);
+  state_position_ = 0;
+}
+
+/**
+ * @brief Fills a block with uniformly distributed numbers out of [0, 1).
+ *
+ * Each number is a tempered 64-bit output of the generator divided by 2^64,
+ * which is how std::uniform_real_distribution<double> converts the outputs of
+ * a std::mt19937_64 as well. Outputs that are rounded up to 1 are replaced by
+ * the largest double below 1, as done in libstdc++.
+ *
+ * The conversion with toDouble() is correctly rounded like a cast, but
+ * allows to vectorize the loop.
+ *
+ * @param uniforms The block to fill.
+ * @param number The number of elements of the block.
+ */
+void MersenneTwister::sampleUniforms(double* uniforms, const size_t number) {
+  const double scale = 1.0 / 18446744073709551616.0; // 2^-64
+  const double below_one = std::nextafter(1.0, 0.0);
+
+  for (size_t i = 0; i < number; ) {
+    if (state_position_ == kStateSize) twist();
+    const size_t end = std::min(number, i + kStateSize - state_position_);
+    uint64_t const* words = state_ + state_position_ - i;
+
+    for (size_t j = i; j < end; ++j) {
+      uint64_t bits = words[j];
+      bits ^= (bits >> 29) & 0x5555555555555555;
+      bits ^= (bits << 17) & 0x71d67fffeda60000;
+      bits ^= (bits << 37) & 0xfff7eee000000000;
+      bits ^= bits >> 43;
+
+      double value = toDouble(bits) * scale;
+      uniforms[j] = value < 1.0 ? value : below_one;
+    }
+    state_position_ += end - i;
+    i = end;
+  }
+}
@@ -25,8 +25,16 @@
 
 #include <random>
 #include <memory>
+#include <cstdint>
 #include "random_generator.h"
 
+/**
+ * @brief The 64-bit Mersenne Twister MT19937-64.
+ *
+ * The generator gives the same numbers as std::mt19937_64, but generates and
+ * tempers its outputs a complete state of 312 words at a time, in loops that
+ * the compiler can vectorize.
+ */
 class MersenneTwister : public RandomGenerator
 {
  public:
@@ -45,16 +53,22 @@ class MersenneTwister : public RandomGenerator
   ~MersenneTwister() {};
 
   void set_seed(const size_t seed);
+  void set_stream(const size_t stream);
   void construct_common(const size_t seed);
 
-  double sample() { return unif_(mt_); }
+#ifdef UNITTEST
+  friend class TestRandomGenerator;
+#endif
 
  protected:
-  std::mt19937_64 mt_; 
-  std::uniform_real_distribution<> unif_;
+  void sampleUniforms(double* uniforms, const size_t number);
 
  private:
-  size_t generateRandomSeed() const;
+  void twist();
+
+  static const size_t kStateSize = 312;
+  uint64_t state_[kStateSize];
+  size_t state_position_;   // The next word of the state to output
 };
 
 #endif
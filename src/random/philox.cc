@@ -0,0 +1,142 @@
+/*
+ * scrm is an implementation of the Sequential-Coalescent-with-Recombination Model.
+ * 
+ * Copyright (C) 2013, 2014 Paul R. Staab, Sha (Joe) Zhu, Dirk Metzler and Gerton Lunter
+ * 
+ * This file is part of scrm.
+ * 
+ * scrm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "philox.h"
+
+void Philox::set_seed(const size_t seed) {
+  RandomGenerator::set_seed(seed);
+  key_[0] = static_cast<uint32_t>(seed);
+  key_[1] = static_cast<uint32_t>((uint64_t)seed >> 32);
+  this->setCounter(0);
+  this->initializeUnitExponential();
+}
+
+// The streams use the upper halves 1, 2, ..., such that they differ from the
+// numbers obtained without streams.
+void Philox::set_stream(const size_t stream) {
+  this->discardBuffer();
+  this->setCounter((uint64_t)stream + 1);
+  this->initializeUnitExponential();
+}
+
+void Philox::setCounter(const uint64_t upper) {
+  counter_[0] = 0;
+  counter_[1] = 0;
+  counter_[2] = static_cast<uint32_t>(upper);
+  counter_[3] = static_cast<uint32_t>(upper >> 32);
+  has_spare_ = false;
+}
+
+void Philox::encrypt(const uint32_t counter[4], const uint32_t key[2], uint32_t result[4]) {
+  uint32_t c0 = counter[0], c1 = counter[1], c2 = counter[2], c3 = counter[3];
+  uint32_t k0 = key[0], k1 = key[1];
+  for (size_t round = 0; round < 10; ++round) {
+    const uint64_t product0 = (uint64_t)0xD2511F53 * c0;
+    const uint64_t product1 = (uint64_t)0xCD9E8D57 * c2;
+    c0 = static_cast<uint32_t>(product1 >> 32) ^ c1 ^ k0;
+    c2 = static_cast<uint32_t>(product0 >> 32) ^ c3 ^ k1;
+    c1 = static_cast<uint32_t>(product1);
+    c3 = static_cast<uint32_t>(product0);
+    k0 += 0x9E3779B9;
+    k1 += 0xBB67AE85;
+  }
+  result[0] = c0;
+  result[1] = c1;
+  result[2] = c2;
+  result[3] = c3;
+}
+
+/**
+ * @brief Fills a block with uniformly distributed numbers out of (0, 1).
+ *
+ * Each counter value gives two numbers from the upper 53 bits of two pairs of
+ * words. They are centered in their interval such that zero can not occur.
+ * The lower half of the counter is incremented for each pair of numbers, and
+ * a second number that was not needed is kept for the next block.
+ */
+void Philox::sampleUniforms(double* uniforms, const size_t number) {
+  const double scale = 1.0 / 9007199254740992.0; // 2^-53
+  size_t i = 0;
+  if (has_spare_ && number > 0) {
+    uniforms[i++] = spare_;
+    has_spare_ = false;
+  }
+
+  // Encrypt kLanes consecutive counters at once
+  while (i + 2 * kLanes <= number) {
+    encryptLanes(uniforms + i);
+    i += 2 * kLanes;
+  }
+
+  uint32_t words[4];
+  while (i < number) {
+    encrypt(counter_, key_, words);
+    if (++counter_[0] == 0) ++counter_[1];
+
+    uint64_t first = ((uint64_t)words[1] << 32) | words[0];
+    uint64_t second = ((uint64_t)words[3] << 32) | words[2];
+    uniforms[i++] = ((first >> 11) + 0.5) * scale;
+    double value = ((second >> 11) + 0.5) * scale;
+    if (i < number) uniforms[i++] = value;
+    else {
+      spare_ = value;
+      has_spare_ = true;
+    }
+  }
+}
+
+// Gives the same numbers as encrypting the next kLanes counters one after
+// another, but runs the rounds for all of them in loops over the counters,
+// which the compiler can vectorize.
+void Philox::encryptLanes(double* uniforms) {
+  const double scale = 1.0 / 9007199254740992.0; // 2^-53
+  uint32_t c0[kLanes], c1[kLanes], c2[kLanes], c3[kLanes];
+  for (size_t j = 0; j < kLanes; ++j) {
+    c0[j] = counter_[0] + (uint32_t)j;
+    c1[j] = counter_[1] + (c0[j] < counter_[0]);
+    c2[j] = counter_[2];
+    c3[j] = counter_[3];
+  }
+
+  uint32_t k0 = key_[0], k1 = key_[1];
+  for (size_t round = 0; round < 10; ++round) {
+    for (size_t j = 0; j < kLanes; ++j) {
+      const uint64_t product0 = (uint64_t)0xD2511F53 * c0[j];
+      const uint64_t product1 = (uint64_t)0xCD9E8D57 * c2[j];
+      c0[j] = (uint32_t)(product1 >> 32) ^ c1[j] ^ k0;
+      c2[j] = (uint32_t)(product0 >> 32) ^ c3[j] ^ k1;
+      c1[j] = (uint32_t)product1;
+      c3[j] = (uint32_t)product0;
+    }
+    k0 += 0x9E3779B9;
+    k1 += 0xBB67AE85;
+  }
+
+  for (size_t j = 0; j < kLanes; ++j) {
+    uniforms[2*j] = (toDouble((((uint64_t)c1[j] << 32) | c0[j]) >> 11) + 0.5) * scale;
+    uniforms[2*j+1] = (toDouble((((uint64_t)c3[j] << 32) | c2[j]) >> 11) + 0.5) * scale;
+  }
+
+  uint32_t lower = counter_[0];
+  counter_[0] += kLanes;
+  if (counter_[0] < lower) ++counter_[1];
+}
@@ -0,0 +1,73 @@
+/*
+ * scrm is an implementation of the Sequential-Coalescent-with-Recombination Model.
+ * 
+ * Copyright (C) 2013, 2014 Paul R. Staab, Sha (Joe) Zhu, Dirk Metzler and Gerton Lunter
+ * 
+ * This file is part of scrm.
+ * 
+ * scrm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef scrm_src_random_philox
+#define scrm_src_random_philox
+
+#include <cstdint>
+#include "random_generator.h"
+
+/**
+ * @brief The counter-based Philox4x32-10 generator of Salmon et al.
+ *
+ * Philox encrypts a 128-bit counter with a 64-bit key in ten rounds of
+ * multiplications, and each counter value gives four 32-bit words. The seed
+ * is used as key. Philox4x32-10 passes the BigCrush test suite of TestU01 for
+ * many different keys and counter patterns. See J. K. Salmon, M. A. Moraes, R. O. Dror and D. E. Shaw,
+ * Parallel Random Numbers: As Easy as 1, 2, 3, Proceedings of SC11 (2011).
+ *
+ * As the numbers depend only on the key and the counter, streams are
+ * obtained by using the number of the stream as upper half of the counter,
+ * without any initialization. Only the lower 64 bits of the counter are
+ * incremented, so each stream has a period of 2^64 counter values, that is
+ * 2^66 words or 2^65 numbers out of (0, 1), and never runs into another one.
+ */
+class Philox : public RandomGenerator
+{
+ public:
+  Philox(const size_t seed) { this->set_seed(seed); }
+  ~Philox() {};
+
+  void set_seed(const size_t seed);
+  void set_stream(const size_t stream);
+
+  // Encrypts the counter with the key, giving four random words.
+  static void encrypt(const uint32_t counter[4], const uint32_t key[2], uint32_t result[4]);
+
+ protected:
+  void sampleUniforms(double* uniforms, const size_t number);
+
+ private:
+  void setCounter(const uint64_t upper);
+  void encryptLanes(double* uniforms);
+
+  static const size_t kLanes = 32;
+
+  uint32_t key_[2];
+  uint32_t counter_[4];
+
+  // The second number of the last block, if it was not used yet
+  double spare_;
+  bool has_spare_;
+};
+
+#endif
@@ -23,6 +23,33 @@
 #include "random_generator.h"
 #include <iostream>
 #include <cmath>
+#include <random>
+#include <stdexcept>
+
+#include "mersenne_twister.h"
+#include "xoshiro256.h"
+#include "philox.h"
+
+RandomGenerator* RandomGenerator::create(const GeneratorType type, const size_t seed) {
+  switch (type) {
+    case mersenne_twister: return new MersenneTwister(seed);
+    case xoshiro256: return new Xoshiro256(seed);
+    case philox4x32: return new Philox(seed);
+  }
+  throw std::invalid_argument("Unknown random generator");
+}
+
+/**
+ * @brief Generates a random seed using entropy provided by the operating
+ * system. 
+ *
+ * @return A random int between 0 and 2^32
+ */
+size_t RandomGenerator::generateRandomSeed() {
+  std::random_device rd;
+  std::uniform_int_distribution<size_t> dist(0, 4294967295); // 0 - 2^32-1
+  return(dist(rd));
+}
 
 // Samples waiting time, with limit, for a process with an exponentially changing rate:
 //  rate(t) = b exp( c t )
@@ -27,28 +27,59 @@
 
 #include <cassert>
 #include <cmath>
+#include <cstdint>
+#include <cstring>
 #include <memory>
 
 #include "fastfunc.h"
 
 
+// The pseudo random number generators that can be used for the simulation
+enum GeneratorType { mersenne_twister, xoshiro256, philox4x32 };
+
 class RandomGenerator
 {
  friend class MersenneTwister;
  public:
-  RandomGenerator() : ff_(std::make_shared<FastFunc>()) { };
-  RandomGenerator(std::shared_ptr<FastFunc> ff) : ff_(ff) { };
+  RandomGenerator() : buffer_position_(kBufferSize), ff_(std::make_shared<FastFunc>()) { };
+  RandomGenerator(std::shared_ptr<FastFunc> ff) : buffer_position_(kBufferSize), ff_(ff) { };
 
   virtual ~RandomGenerator() {}
 
+  // Creates a generator of the given type that is initialized with seed
+  static RandomGenerator* create(const GeneratorType type, const size_t seed);
+
+  // Generates a random seed using entropy provided by the operating system
+  static size_t generateRandomSeed();
+
   //Getters & Setters
   size_t seed() const { return seed_; }
 
   virtual void set_seed(const size_t seed) {
     this->seed_ = seed;
+    this->discardBuffer();
+  }
+
+  // Switches to an independent random stream, which is determined only by the
+  // seed and the stream's number. Generators that can not provide independent
+  // streams ignore this.
+  virtual void set_stream(const size_t stream) { (void) stream; }
+
+  // Uniformly samples a number out of [0, 1). The numbers are taken from a
+  // buffer that is refilled in blocks by the generator.
+  double sample() {
+    if (buffer_position_ == kBufferSize) refillBuffer();
+    return uniforms_[buffer_position_++];
   }
 
-  virtual double sample() =0;
+  // Fills `values` with the next `number` uniformly distributed numbers, in
+  // the same order as repeatedly calling sample() would return them.
+  void sample(double* values, size_t number) {
+    for (; number > 0 && buffer_position_ < kBufferSize; --number) {
+      *(values++) = uniforms_[buffer_position_++];
+    }
+    if (number > 0) sampleUniforms(values, number);
+  }
 
   // Base class methods
   // Initialize unit_exponential; must be called when the random generator is up and running
@@ -88,13 +119,46 @@ class RandomGenerator
  protected:
   // Sample from a unit exponential distribution
   // Unit tested
-  // fastlog can return 0, which causes a bug in scrm.
-  // log or fastlog does seems to have an influence on the runtime.
-  virtual double sampleUnitExponential() {
-    return -(this->ff()->fastlog(sample()));
-    //return -std::log(sample());
+  // The exponentials are calculated from the buffered uniforms when the
+  // buffer is refilled, and consume the same position in the stream.
+  double sampleUnitExponential() {
+    if (buffer_position_ == kBufferSize) refillBuffer();
+    return exponentials_[buffer_position_++];
+  }
+
+  // Fills `uniforms` with `number` uniformly distributed numbers out of
+  // [0, 1), in the order in which the generator would draw them one by one.
+  virtual void sampleUniforms(double* uniforms, const size_t number) =0;
+
+  // Drops the buffered numbers, e.g. after the generator was reseeded.
+  void discardBuffer() { buffer_position_ = kBufferSize; }
+
+  // Converts a 64-bit integer into the nearest double. The upper and lower 32
+  // bits are exact when placed in the mantissas of 2^84 and 2^52, such that
+  // only their sum is rounded. Unlike a cast, this needs no branch on the
+  // highest bit and can be vectorized with SSE2.
+  static double toDouble(const uint64_t bits) {
+    uint64_t high_bits = (bits >> 32) | 0x4530000000000000;
+    uint64_t low_bits = (bits & 0xffffffff) | 0x4330000000000000;
+    double high, low;
+    std::memcpy(&high, &high_bits, sizeof(double));
+    std::memcpy(&low, &low_bits, sizeof(double));
+    return (high - 19342813118337666422669312.0) + low; // 2^84 + 2^52
   }
 
+ private:
+  void refillBuffer() {
+    sampleUniforms(uniforms_, kBufferSize);
+    FastFunc::blocklog(uniforms_, exponentials_, kBufferSize);
+    for (size_t i = 0; i < kBufferSize; ++i) exponentials_[i] = -exponentials_[i];
+    buffer_position_ = 0;
+  }
+
+  static const size_t kBufferSize = 256;
+  double uniforms_[kBufferSize];
+  double exponentials_[kBufferSize];
+  size_t buffer_position_;
+
  protected:
   // seed
   size_t seed_;
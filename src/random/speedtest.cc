@@ -20,6 +20,7 @@
 
 */
 
+#include <memory>
 #include "fastfunc.h"
 #include "mersenne_twister.h"
 
@@ -62,6 +63,37 @@ double speedtest(int oper, double rate, double growth, double limit) {
   return z + zf;  // to avoid optimizing everything away
 }
 
+// Reports the number of draws per second for each way of sampling
+void speedtest_draws(GeneratorType type, const char* generator) {
+
+  const int DRAWS=50000000;
+  const int BLOCK=1024;
+  const char* names[6] = {"sample()","sample(block)","sampleInt(10)","sampleExpo(1.0)",
+                          "sampleExpoLimit(1.0,0.1)","sampleExpoExpoLimit(1.0,1.0,1.0)"};
+  std::unique_ptr<RandomGenerator> generator_ptr(RandomGenerator::create(type, 1));
+  RandomGenerator& rg = *generator_ptr;
+  double block[BLOCK];
+
+  printf("Path (%s)\t\t\t\tDraws/s\n", generator);
+  for (int path=0; path<6; path++) {
+    double z = 0.0;
+    clock_t start = clock();
+    for (int i=0; i<DRAWS; i++) {
+      switch(path) {
+      case 0: z += rg.sample(); break;
+      case 1: if (i % BLOCK == 0) { rg.sample(block, BLOCK); z += block[0]; } break;
+      case 2: z += rg.sampleInt( 10 ); break;
+      case 3: z += rg.sampleExpo( 1.0 ); break;
+      case 4: z += rg.sampleExpoLimit( 1.0, 0.1 ); break;
+      default: z += rg.sampleExpoExpoLimit( 1.0, 1.0, 1.0 ); break;
+      }
+    }
+    double seconds = double(clock() - start) / CLOCKS_PER_SEC;
+    printf("%-40s%1.3e\t(%g)\n", names[path], DRAWS / seconds, z);
+  }
+}
+
+
 //
 // set of unit tests
 //
@@ -133,6 +165,7 @@ bool unittest_maxdiff_monotone( char func, class FastFunc& ff) {
     y0 = y2;
   }
   std::cout << " max abs diff across [0.5-1.5] = " << maxdiff << std::endl;
+  return true;
 }
 
 
@@ -188,6 +221,10 @@ int main(int argc, char** argv) {
 
   speedtest_log();
 
+  speedtest_draws(mersenne_twister, "mt");
+  speedtest_draws(xoshiro256, "xoshiro");
+  speedtest_draws(philox4x32, "philox");
+
   printf("Test\t\tRate\tGrowth\tLimit\tTime\n");
   for (int i=0; i<LLTEST + CASES; i++) {
     clock_t start = clock(), diff;
@@ -0,0 +1,61 @@
+/*
+ * scrm is an implementation of the Sequential-Coalescent-with-Recombination Model.
+ * 
+ * Copyright (C) 2013, 2014 Paul R. Staab, Sha (Joe) Zhu, Dirk Metzler and Gerton Lunter
+ * 
+ * This file is part of scrm.
+ * 
+ * scrm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "xoshiro256.h"
+
+void Xoshiro256::set_seed(const size_t seed) {
+  RandomGenerator::set_seed(seed);
+  this->initializeState(0);
+  this->initializeUnitExponential();
+}
+
+void Xoshiro256::set_stream(const size_t stream) {
+  this->discardBuffer();
+  this->initializeState(4 * ((uint64_t)stream + 1));
+  this->initializeUnitExponential();
+}
+
+/**
+ * @brief Sets the state to the outputs of SplitMix64 seeded with the seed,
+ * starting with its output number 'position'.
+ *
+ * SplitMix64 is a bijection of its counter, so different positions give
+ * different states, and the state can never become zero for all four words.
+ */
+void Xoshiro256::initializeState(uint64_t position) {
+  uint64_t counter = (uint64_t)seed() + position * 0x9e3779b97f4a7c15;
+  for (size_t i = 0; i < 4; ++i) {
+    uint64_t z = (counter += 0x9e3779b97f4a7c15);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+    state_[i] = z ^ (z >> 31);
+  }
+}
+
+// Uses the upper 53 bits of each output, centered in its interval such that
+// the numbers are in (0, 1) and zero can not occur.
+void Xoshiro256::sampleUniforms(double* uniforms, const size_t number) {
+  const double scale = 1.0 / 9007199254740992.0; // 2^-53
+  for (size_t i = 0; i < number; ++i) {
+    uniforms[i] = ((next() >> 11) + 0.5) * scale;
+  }
+}
@@ -0,0 +1,81 @@
+/*
+ * scrm is an implementation of the Sequential-Coalescent-with-Recombination Model.
+ * 
+ * Copyright (C) 2013, 2014 Paul R. Staab, Sha (Joe) Zhu, Dirk Metzler and Gerton Lunter
+ * 
+ * This file is part of scrm.
+ * 
+ * scrm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef scrm_src_random_xoshiro256
+#define scrm_src_random_xoshiro256
+
+#include <cstdint>
+#include "random_generator.h"
+
+/**
+ * @brief The xoshiro256** generator of Blackman and Vigna.
+ *
+ * xoshiro256** has a state of 256 bits and a period of 2^256 - 1. It passes
+ * the BigCrush test suite of TestU01 and PractRand up to at least 32TB, and
+ * its outputs are 4-dimensionally equidistributed. See D. Blackman and
+ * S. Vigna, Scrambled Linear Pseudorandom Number Generators, ACM Transactions
+ * on Mathematical Software 47 (2021).
+ *
+ * The state is initialized from the seed with the SplitMix64 generator, as
+ * recommended by the authors. Stream i uses the four outputs of SplitMix64
+ * following those used by stream i-1, such that no two streams start from the
+ * same state.
+ */
+class Xoshiro256 : public RandomGenerator
+{
+ public:
+  Xoshiro256(const size_t seed) { this->set_seed(seed); }
+  ~Xoshiro256() {};
+
+  void set_seed(const size_t seed);
+  void set_stream(const size_t stream);
+
+  // Returns the next 64-bit output of the generator
+  uint64_t next() {
+    const uint64_t result = rotl(state_[1] * 5, 7) * 9;
+    const uint64_t t = state_[1] << 17;
+    state_[2] ^= state_[0];
+    state_[3] ^= state_[1];
+    state_[1] ^= state_[2];
+    state_[0] ^= state_[3];
+    state_[2] ^= t;
+    state_[3] = rotl(state_[3], 45);
+    return result;
+  }
+
+#ifdef UNITTEST
+  friend class TestXoshiro256;
+#endif
+
+ protected:
+  void sampleUniforms(double* uniforms, const size_t number);
+
+ private:
+  static uint64_t rotl(const uint64_t x, const int k) {
+    return (x << k) | (x >> (64 - k));
+  }
+  void initializeState(uint64_t position);
+
+  uint64_t state_[4];
+};
+
+#endif
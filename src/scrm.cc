@@ -21,13 +21,10 @@
 */
 
 #include <iostream>
-#include <ctime>
-#include <memory>
+#include <cstdlib>
 
 #include "param.h"
-#include "forest.h"
-#include "random/random_generator.h"
-#include "random/mersenne_twister.h"
+#include "simulate.h"
 
 
 #ifndef UNITTEST
@@ -39,7 +36,6 @@ int main(int argc, char *argv[]){
     // Parse command line arguments
     Param user_para(argc, argv);
     Model model = user_para.parse();
-    output->precision(user_para.precision());
 
     // Print help if user asked for it
     if (user_para.help()) {
@@ -51,39 +47,7 @@ int main(int argc, char *argv[]){
       return EXIT_SUCCESS;
     }
 
-    MersenneTwister rg(user_para.seed_is_set(), user_para.random_seed());
-    *output << user_para << std::endl;
-    *output << rg.seed() << std::endl;
-
-    if (user_para.print_model()) {
-      *output << model << std::endl;
-    }
-
-    // Create the forest
-    Forest forest = Forest(&model, &rg);
-
-    // Loop over the independent loci/chromosomes
-    for (size_t rep_i=0; rep_i < model.loci_number(); ++rep_i) {
-      // Mark the start of a new independent sample
-      *output << std::endl << "//" << std::endl;
-
-      // Now set up the ARG, and sample the initial tree
-      if ( user_para.read_init_genealogy() )
-        forest.readNewick ( user_para.init_genealogy[ rep_i % user_para.init_genealogy.size()] );
-      else forest.buildInitialTree();
-      forest.printSegmentSumStats(*output);
-
-      while (forest.next_base() < model.loci_length()) { 
-        // Sample next genealogy
-        forest.sampleNextGenealogy();
-        forest.printSegmentSumStats(*output);
-      }
-      assert(forest.next_base() == model.loci_length());
-
-      forest.printLocusSumStats(*output);
-      forest.clear();
-    }
-
+    simulate(user_para, model, *output);
     return EXIT_SUCCESS;
   }
 
@@ -95,4 +59,3 @@ int main(int argc, char *argv[]){
 }
 
 #endif
-
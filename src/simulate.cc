@@ -0,0 +1,224 @@
+/*
+ * scrm is an implementation of the Sequential-Coalescent-with-Recombination Model.
+ * 
+ * Copyright (C) 2013, 2014 Paul R. Staab, Sha (Joe) Zhu, Dirk Metzler and Gerton Lunter
+ * 
+ * This file is part of scrm.
+ * 
+ * scrm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "simulate.h"
+
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+
+#include "output_buffer.h"
+#include "random/random_generator.h"
+
+// Simulates the locus with number rep_i (counting from zero) and prints its output.
+// The output is buffered and the stream is flushed once at the end of the locus.
+void simulateLocus(Forest &forest, Param &user_para, const size_t rep_i,
+                   std::ostream &stream, SimulationSummary &summary) {
+  OutputBuffer output(stream);
+
+  // Mark the start of a new independent sample
+  if (!user_para.compact_output()) output << "\n//\n";
+
+  // Now set up the ARG, and sample the initial tree
+  if ( user_para.read_init_genealogy() )
+    forest.readNewick ( user_para.init_genealogy[ rep_i % user_para.init_genealogy.size()] );
+  else forest.buildInitialTree();
+  forest.printSegmentSumStats(output);
+  ++summary.segments;
+  summary.max_nodes = std::max(summary.max_nodes, forest.nodes()->size());
+
+  while (forest.next_base() < forest.model().loci_length()) { 
+    // Sample next genealogy
+    forest.sampleNextGenealogy();
+    forest.printSegmentSumStats(output);
+    ++summary.segments;
+    summary.max_nodes = std::max(summary.max_nodes, forest.nodes()->size());
+  }
+  assert(forest.next_base() == forest.model().loci_length());
+
+  forest.printLocusSumStats(output);
+  output.flush();
+  forest.clear();
+}
+
+
+/**
+ * @brief Simulates the loci using multiple threads.
+ *
+ * Each thread uses its own copy of the model, random generator and forest, and
+ * switches the generator to the random stream of a locus before simulating it.
+ * The output of the loci is collected by the calling thread and printed in the
+ * order of the loci, such that it does not depend on the number of threads.
+ * The summaries and performance counters of all threads are added to
+ * 'summary' and 'stats'.
+ */
+void simulateLociParallel(const Model &model, Param &user_para,
+                          const size_t seed, std::ostream &output,
+                          SimulationSummary &summary, Stats &stats) {
+  const size_t loci_number = model.loci_number();
+  const size_t thread_number = std::min(user_para.threads(), loci_number);
+
+  // Limits the number of loci that are simulated ahead of the output
+  const size_t max_ahead = 4 * thread_number;
+
+  std::mutex mutex;
+  std::condition_variable changed;
+  std::map<size_t, std::string> finished_loci;
+  std::exception_ptr error = NULL;
+  size_t next_locus = 0, next_output = 0;
+
+  auto worker = [&]() {
+    try {
+      Model thread_model(model);
+      thread_model.cloneSummaryStatistics();
+      std::unique_ptr<RandomGenerator> rg(
+          RandomGenerator::create(user_para.random_generator(), seed));
+      Forest forest(&thread_model, rg.get());
+
+      std::ostringstream locus_output;
+      locus_output.precision(output.precision());
+      SimulationSummary thread_summary = { 0, 0 };
+
+      while (true) {
+        size_t rep_i;
+        {
+          std::unique_lock<std::mutex> lock(mutex);
+          if (next_locus >= loci_number || error != NULL) break;
+          rep_i = next_locus++;
+          changed.wait(lock, [&]() {
+            return rep_i < next_output + max_ahead || error != NULL; 
+          });
+          if (error != NULL) break;
+        }
+
+        rg->set_stream(user_para.first_locus() + rep_i);
+        locus_output.str("");
+        simulateLocus(forest, user_para, user_para.first_locus() + rep_i,
+                      locus_output, thread_summary);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        finished_loci[rep_i] = locus_output.str();
+        changed.notify_all();
+      }
+
+      std::lock_guard<std::mutex> lock(mutex);
+      summary.segments += thread_summary.segments;
+      summary.max_nodes = std::max(summary.max_nodes, thread_summary.max_nodes);
+#ifdef SCRM_STATS
+      stats += forest.stats();
+#else
+      (void)stats;
+#endif
+    } catch (...) {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (error == NULL) error = std::current_exception();
+      changed.notify_all();
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < thread_number; ++i) threads.push_back(std::thread(worker));
+
+  // Print the loci in order as soon as they are finished.
+  std::unique_lock<std::mutex> lock(mutex);
+  while (next_output < loci_number) {
+    changed.wait(lock, [&]() { 
+      return finished_loci.count(next_output) > 0 || error != NULL;
+    });
+    if (error != NULL) break;
+
+    output << finished_loci[next_output];
+    finished_loci.erase(next_output);
+    ++next_output;
+    changed.notify_all();
+  }
+  lock.unlock();
+
+  for (std::thread &thread : threads) thread.join();
+  if (error != NULL) std::rethrow_exception(error);
+}
+
+
+#ifdef SCRM_STATS
+void printStats(const Stats &stats, const std::chrono::steady_clock::time_point start) {
+  stats.printJson(std::cerr, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+}
+#endif
+
+
+SimulationSummary simulate(Param &user_para, Model &model, std::ostream &output) {
+  STATS(auto start = std::chrono::steady_clock::now());
+  SimulationSummary summary = { 0, 0 };
+  output.precision(user_para.precision());
+
+  size_t seed = user_para.seed_is_set() ? user_para.random_seed() :
+                                          RandomGenerator::generateRandomSeed();
+  std::unique_ptr<RandomGenerator> rg(
+      RandomGenerator::create(user_para.random_generator(), seed));
+  output << user_para << std::endl;
+  output << rg->seed() << std::endl;
+
+  if (user_para.print_model()) {
+    output << model << std::endl;
+  }
+
+  {
+    OutputBuffer header(output);
+    for (size_t i = 0; i < model.countSummaryStatistics(); ++i) {
+      model.getSummaryStatistic(i)->printRunHeader(header);
+    }
+  }
+
+  if (user_para.threads() > 0) {
+    Stats stats;
+    simulateLociParallel(model, user_para, rg->seed(), output, summary, stats);
+    STATS(if (user_para.print_stats()) printStats(stats, start));
+    return summary;
+  }
+
+  // Create the forest
+  Forest forest = Forest(&model, rg.get());
+
+  // Loop over the independent loci/chromosomes
+  for (size_t rep_i=0; rep_i < model.loci_number(); ++rep_i) {
+    if (user_para.streams()) rg->set_stream(user_para.first_locus() + rep_i);
+    simulateLocus(forest, user_para, user_para.first_locus() + rep_i, output, summary);
+  }
+
+  {
+    OutputBuffer footer(output);
+    for (size_t i = 0; i < model.countSummaryStatistics(); ++i) {
+      model.getSummaryStatistic(i)->printRunOutput(footer);
+    }
+  }
+
+  STATS(if (user_para.print_stats()) printStats(forest.stats(), start));
+  return summary;
+}
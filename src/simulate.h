@@ -0,0 +1,63 @@
+/*
+ * scrm is an implementation of the Sequential-Coalescent-with-Recombination Model.
+ *
+ * Copyright (C) 2013, 2014 Paul R. Staab, Sha (Joe) Zhu, Dirk Metzler and Gerton Lunter
+ *
+ * This file is part of scrm.
+ *
+ * scrm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+/*!
+ * \file simulate.h
+ * \brief The simulation loop of the scrm binary.
+ *
+ * It is shared between scrm's main function and the benchmarks, such that
+ * the benchmarks time exactly the code that scrm runs.
+ */
+
+#ifndef scrm_src_simulate
+#define scrm_src_simulate
+
+#include <cstddef>
+#include <ostream>
+
+#include "param.h"
+#include "model.h"
+#include "forest.h"
+#include "stats.h"
+
+// What was simulated, as reported by the benchmarks.
+struct SimulationSummary {
+  size_t segments;   // Genealogies of a part of a locus
+  size_t max_nodes;  // The largest number of nodes after a segment
+};
+
+void simulateLocus(Forest &forest, Param &user_para, const size_t rep_i,
+                   std::ostream &stream, SimulationSummary &summary);
+
+void simulateLociParallel(const Model &model, Param &user_para,
+                          const size_t seed, std::ostream &output,
+                          SimulationSummary &summary, Stats &stats);
+
+/**
+ * @brief Simulates the loci of the model like the scrm binary does.
+ *
+ * Prints the command line, the seed and the output of all summary statistics
+ * to 'output', and the performance counters to stderr if they were requested.
+ */
+SimulationSummary simulate(Param &user_para, Model &model, std::ostream &output);
+
+#endif
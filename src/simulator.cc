@@ -0,0 +1,140 @@
+/*
+ * scrm is an implementation of the Sequential-Coalescent-with-Recombination Model.
+ * 
+ * Copyright (C) 2013, 2014 Paul R. Staab, Sha (Joe) Zhu, Dirk Metzler and Gerton Lunter
+ * 
+ * This file is part of scrm.
+ * 
+ * scrm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "simulator.h"
+
+Simulator::Simulator(const Model &model, const size_t seed, 
+                     const GeneratorType generator) : 
+  model_(model), 
+  random_generator_(RandomGenerator::create(generator, seed)),
+  streams_(false), next_locus_(0), 
+  seg_sites_(NULL), delivered_mutations_(0) {
+
+  // The summary statistics store the results of a locus, and therefore must
+  // not be shared with the original model.
+  model_.cloneSummaryStatistics();
+  for (size_t i = 0; i < model_.countSummaryStatistics(); ++i) {
+    SegSites* seg_sites = dynamic_cast<SegSites*>(model_.getSummaryStatistic(i));
+    if (seg_sites != NULL) {
+      seg_sites_ = seg_sites;
+      break;
+    }
+  }
+
+  forest_.reset(new Forest(&model_, random_generator_.get()));
+}
+
+
+// Mutations are only simulated by SegSites, which is added to the model if it
+// does not have it yet.
+void Simulator::set_mutation_callback(std::function<void(const Mutation&)> callback) {
+  if (seg_sites_ == NULL) {
+    auto seg_sites = std::make_shared<SegSites>();
+    model_.addSummaryStatistic(seg_sites);
+    seg_sites_ = seg_sites.get();
+  }
+  mutation_callback_ = callback;
+}
+
+
+void Simulator::simulate() {
+  simulate(model_.loci_number());
+}
+
+
+void Simulator::simulate(const size_t loci) {
+  for (size_t i = 0; i < loci; ++i) {
+    const size_t locus = next_locus_++;
+    if (streams_) random_generator_->set_stream(locus);
+    delivered_mutations_ = 0;
+
+    forest_->buildInitialTree();
+    deliverSegment(locus);
+    while (forest_->next_base() < model_.loci_length()) {
+      forest_->sampleNextGenealogy();
+      deliverSegment(locus);
+    }
+
+    if (locus_callback_) locus_callback_(locus);
+    forest_->clear();
+  }
+}
+
+
+void Simulator::deliverSegment(const size_t locus) {
+  const double start = forest_->current_base();
+  const double end = forest_->next_base();
+
+  if (end > start) {
+    if (segment_callback_) {
+      Segment segment = { locus, start, end, forest_.get() };
+      segment_callback_(segment);
+    }
+
+    if (tree_callback_) {
+      const size_t sample_size = model_.sample_size();
+      parents_.resize(2 * sample_size - 1);
+      heights_.resize(2 * sample_size - 1);
+      size_t position = 2 * sample_size - 2;
+      addTreeNode(forest_->local_root(), position, -1);
+      assert( position == sample_size - 1 );
+
+      Tree tree = { locus, start, end, &parents_, &heights_ };
+      tree_callback_(tree);
+    }
+  }
+
+  if (mutation_callback_) {
+    for (; delivered_mutations_ < seg_sites_->countMutations(); ++delivered_mutations_) {
+      const size_t j = delivered_mutations_;
+      Mutation mutation = { locus, 
+                            seg_sites_->positions()->at(j),
+                            seg_sites_->heights()->at(j), 
+                            seg_sites_->getDerivedCount(j),
+                            seg_sites_->store_haplotypes() ? 
+                              seg_sites_->getHaplotypeWords(j) : NULL,
+                            seg_sites_->words_per_site() };
+      mutation_callback_(mutation);
+    }
+  }
+}
+
+
+// Adds the local tree below node to the oriented forest. Samples are placed
+// at the position given by their label, and the other nodes at decreasing
+// positions starting with the root.
+void Simulator::addTreeNode(Node const* node, size_t &position, const int parent) {
+  size_t node_position;
+  if (node->in_sample()) {
+    node_position = node->label() - 1;
+  } else {
+    node_position = position--;
+  }
+  parents_[node_position] = parent;
+  heights_[node_position] = node->height() * model_.scaling_factor();
+  if (node->in_sample()) return;
+
+  Node* child_1 = node->getLocalChild1();
+  Node* child_2 = node->getLocalChild2();
+  if (child_1 != NULL) addTreeNode(child_1, position, node_position);
+  if (child_2 != NULL) addTreeNode(child_2, position, node_position);
+}
@@ -0,0 +1,153 @@
+/*
+ * scrm is an implementation of the Sequential-Coalescent-with-Recombination Model.
+ * 
+ * Copyright (C) 2013, 2014 Paul R. Staab, Sha (Joe) Zhu, Dirk Metzler and Gerton Lunter
+ * 
+ * This file is part of scrm.
+ * 
+ * scrm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+/*
+ * simulator.h
+ *
+ * An interface for using scrm as a library. It is build into libscrm.a
+ * together with the rest of scrm, except for its main function.
+ */
+
+#ifndef scrm_src_simulator
+#define scrm_src_simulator
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "model.h"
+#include "forest.h"
+#include "random/random_generator.h"
+#include "summary_statistics/seg_sites.h"
+
+/**
+ * @brief Simulates a model in-process and passes the results to callbacks.
+ *
+ * The simulator works on its own copy of the model and uses a single forest
+ * for all loci, such that the nodes of the ARG are reused across loci and
+ * calls of simulate(). Nothing is written to any stream. Instead, the
+ * segments of the loci, their local trees and the mutations are passed to the
+ * callbacks that are set. Data that no callback needs is not prepared.
+ *
+ * The summary statistics of the model are calculated as well, and can be
+ * read from model() in the locus callback. As they might format their
+ * output while calculating it, a model created only for the simulator should
+ * contain no summary statistics except for the segregating sites.
+ *
+ * A simulator is not thread safe, but multiple simulators can be used in
+ * parallel. With set_streams(true), the results of each locus depend only on
+ * the seed and the number of the locus, as with scrm's '-streams' option.
+ */
+class Simulator {
+ public:
+  // A segment of a locus, on which the genealogy does not change.
+  struct Segment {
+    size_t locus;          // The number of the locus, counting from zero
+    double start;          // The first base of the segment
+    double end;            // The first base after the segment
+    Forest const* forest;  // The forest, with the local tree of the segment
+  };
+
+  // The local tree of a segment as oriented forest, like with '-O'. Sample i
+  // is node i. The other nodes have higher numbers than their children, and
+  // the root is node 2n-2. Its parent is -1. Heights are in units of 4N0
+  // generations.
+  struct Tree {
+    size_t locus;
+    double start;
+    double end;
+    std::vector<int> const* parents;
+    std::vector<double> const* heights;
+  };
+
+  // A mutation, with its position on the sequence as printed by scrm. The
+  // derived allele of sample i is bit i % 64 of haplotype[i / 64], for
+  // words words, or haplotype is NULL if the haplotypes are not stored.
+  struct Mutation {
+    size_t locus;
+    double position;
+    double height;
+    size_t derived;
+    uint64_t const* haplotype;
+    size_t words;
+  };
+
+  Simulator(const Model &model, const size_t seed,
+            const GeneratorType generator = mersenne_twister);
+  Simulator(const Simulator &other) = delete;
+  Simulator& operator=(const Simulator &other) = delete;
+  ~Simulator() {};
+
+  // Simulates the given number of loci, or all loci of the model. The loci
+  // are numbered consecutively over all calls.
+  void simulate();
+  void simulate(const size_t loci);
+
+  void set_segment_callback(std::function<void(const Segment&)> callback) {
+    segment_callback_ = callback;
+  }
+  void set_tree_callback(std::function<void(const Tree&)> callback) {
+    tree_callback_ = callback;
+  }
+  void set_mutation_callback(std::function<void(const Mutation&)> callback);
+  void set_locus_callback(std::function<void(size_t locus)> callback) {
+    locus_callback_ = callback;
+  }
+
+  void set_streams(const bool streams) { streams_ = streams; }
+  void set_next_locus(const size_t locus) { next_locus_ = locus; }
+
+  Model const& model() const { return model_; }
+  RandomGenerator* random_generator() const { return random_generator_.get(); }
+  size_t next_locus() const { return next_locus_; }
+#ifdef SCRM_STATS
+  // The performance counters of all loci simulated so far
+  const Stats &stats() const { return forest_->stats(); }
+#endif
+
+ private:
+  void deliverSegment(const size_t locus);
+  void addTreeNode(Node const* node, size_t &position, const int parent);
+
+  Model model_;
+  std::unique_ptr<RandomGenerator> random_generator_;
+  std::unique_ptr<Forest> forest_;
+
+  std::function<void(const Segment&)> segment_callback_;
+  std::function<void(const Tree&)> tree_callback_;
+  std::function<void(const Mutation&)> mutation_callback_;
+  std::function<void(size_t)> locus_callback_;
+
+  bool streams_;
+  size_t next_locus_;
+
+  // The segregating sites from which the mutations are delivered
+  SegSites* seg_sites_;
+  size_t delivered_mutations_;
+
+  // Buffers for the trees
+  std::vector<int> parents_;
+  std::vector<double> heights_;
+};
+
+#endif
@@ -0,0 +1,113 @@
+/*
+ * scrm is an implementation of the Sequential-Coalescent-with-Recombination Model.
+ *
+ * Copyright (C) 2013, 2014 Paul R. Staab, Sha (Joe) Zhu, Dirk Metzler and Gerton Lunter
+ *
+ * This file is part of scrm.
+ *
+ * scrm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "stats.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+Stats::Stats() {
+  loci = 0;
+  segments = 0;
+  rate_changes = 0;
+  recombinations = 0;
+  tree_changes = 0;
+  time_intervals = 0;
+  contemporaries_scanned = 0;
+  no_events = 0;
+  coalescences = 0;
+  pw_coalescences = 0;
+  migrations = 0;
+  recombination_events = 0;
+  fixed_time_events = 0;
+  pruned_old = 0;
+  pruned_unneeded = 0;
+  pruned_orphans = 0;
+  update_above_calls = 0;
+  update_above_nodes = 0;
+  update_above_stops = 0;
+  max_nodes = 0;
+  for (size_t i = 0; i < phase_number; ++i) seconds[i] = 0.0;
+  phase_ = initial_tree;
+  phase_start_ = std::chrono::steady_clock::now();
+}
+
+
+Stats& Stats::operator+=(const Stats &other) {
+  loci += other.loci;
+  segments += other.segments;
+  rate_changes += other.rate_changes;
+  recombinations += other.recombinations;
+  tree_changes += other.tree_changes;
+  time_intervals += other.time_intervals;
+  contemporaries_scanned += other.contemporaries_scanned;
+  no_events += other.no_events;
+  coalescences += other.coalescences;
+  pw_coalescences += other.pw_coalescences;
+  migrations += other.migrations;
+  recombination_events += other.recombination_events;
+  fixed_time_events += other.fixed_time_events;
+  pruned_old += other.pruned_old;
+  pruned_unneeded += other.pruned_unneeded;
+  pruned_orphans += other.pruned_orphans;
+  update_above_calls += other.update_above_calls;
+  update_above_nodes += other.update_above_nodes;
+  update_above_stops += other.update_above_stops;
+  max_nodes = std::max(max_nodes, other.max_nodes);
+  for (size_t i = 0; i < phase_number; ++i) seconds[i] += other.seconds[i];
+  return *this;
+}
+
+
+void Stats::printJson(std::ostream &stream, const double total_seconds) const {
+  std::ostringstream json;
+  json << std::fixed << std::setprecision(6)
+       << "{\n"
+       << "  \"loci\": " << loci << ",\n"
+       << "  \"segments\": " << segments << ",\n"
+       << "  \"rate_changes\": " << rate_changes << ",\n"
+       << "  \"recombinations\": " << recombinations << ",\n"
+       << "  \"tree_changes\": " << tree_changes << ",\n"
+       << "  \"time_intervals\": " << time_intervals << ",\n"
+       << "  \"contemporaries_scanned\": " << contemporaries_scanned << ",\n"
+       << "  \"events\": {\"none\": " << no_events
+       << ", \"coalescence\": " << coalescences
+       << ", \"pairwise_coalescence\": " << pw_coalescences
+       << ", \"migration\": " << migrations
+       << ", \"recombination\": " << recombination_events
+       << ", \"fixed_time\": " << fixed_time_events << "},\n"
+       << "  \"pruned_nodes\": {\"old\": " << pruned_old
+       << ", \"unneeded\": " << pruned_unneeded
+       << ", \"orphaned\": " << pruned_orphans << "},\n"
+       << "  \"update_above\": {\"calls\": " << update_above_calls
+       << ", \"nodes\": " << update_above_nodes
+       << ", \"stops\": " << update_above_stops << "},\n"
+       << "  \"max_nodes\": " << max_nodes << ",\n"
+       << "  \"seconds\": {\"initial_tree\": " << seconds[initial_tree]
+       << ", \"genealogies\": " << seconds[genealogies]
+       << ", \"summary_statistics\": " << seconds[summary_statistics]
+       << ", \"output\": " << seconds[output]
+       << ", \"total\": " << total_seconds << "}\n"
+       << "}\n";
+  stream << json.str();
+}
@@ -0,0 +1,104 @@
+/*
+ * scrm is an implementation of the Sequential-Coalescent-with-Recombination Model.
+ *
+ * Copyright (C) 2013, 2014 Paul R. Staab, Sha (Joe) Zhu, Dirk Metzler and Gerton Lunter
+ *
+ * This file is part of scrm.
+ *
+ * scrm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef scrm_src_stats
+#define scrm_src_stats
+
+#include <chrono>
+#include <cstddef>
+#include <ostream>
+
+/**
+ * Instrumentation counters are only compiled when scrm is configured with
+ * --enable-stats. Otherwise, STATS(...) removes the code that updates them.
+ */
+#ifdef SCRM_STATS
+#define STATS(...) __VA_ARGS__
+#else
+#define STATS(...)
+#endif
+
+/**
+ * @brief Counters that describe the work done in a simulation.
+ *
+ * They are collected by the Forest and its TimeIntervalIterator and are
+ * printed as JSON with -stats. Additionally, the wall time is measured for
+ * each phase of the simulation. The time is accounted to the phase that
+ * was started last, such that the phases do not overlap.
+ */
+class Stats {
+ public:
+  enum Phase { initial_tree, genealogies, summary_statistics, output, phase_number };
+
+  Stats();
+
+  void startPhase(const Phase phase) {
+    auto now = std::chrono::steady_clock::now();
+    seconds[phase_] += std::chrono::duration<double>(now - phase_start_).count();
+    phase_ = phase;
+    phase_start_ = now;
+  }
+
+  // Adds the time since the start of the current phase to it
+  void updateTime() { startPhase(phase_); }
+
+  // Adds the counters of another simulation, e.g. of another thread
+  Stats& operator+=(const Stats &other);
+
+  void printJson(std::ostream &stream, const double total_seconds) const;
+
+  size_t loci;
+  size_t segments;
+  size_t rate_changes;        // Segments that start because the model changed
+  size_t recombinations;
+  size_t tree_changes;        // Recombinations that changed the local tree
+
+  size_t time_intervals;
+  size_t contemporaries_scanned;
+
+  // Events by the type of Event, plus the fixed time events of the model
+  size_t no_events;
+  size_t coalescences;
+  size_t pw_coalescences;
+  size_t migrations;
+  size_t recombination_events;
+  size_t fixed_time_events;
+
+  // Nodes removed by Forest::pruneNodeIfNeeded
+  size_t pruned_old;
+  size_t pruned_unneeded;
+  size_t pruned_orphans;
+
+  size_t update_above_calls;
+  size_t update_above_nodes;  // Nodes updated in these calls
+  size_t update_above_stops;  // Calls that stopped because a node was unchanged
+
+  size_t max_nodes;           // The largest number of nodes after a segment
+
+  double seconds[phase_number];
+
+ private:
+  Phase phase_;
+  std::chrono::steady_clock::time_point phase_start_;
+};
+
+#endif
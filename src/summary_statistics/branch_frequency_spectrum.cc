@@ -0,0 +1,46 @@
+/*
+ * scrm is an implementation of the Sequential-Coalescent-with-Recombination Model.
+ * 
+ * Copyright (C) 2013, 2014 Paul R. Staab, Sha (Joe) Zhu, Dirk Metzler and Gerton Lunter
+ * 
+ * This file is part of scrm.
+ * 
+ * scrm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "branch_frequency_spectrum.h"
+
+void BranchFrequencySpectrum::calculate(const Forest &forest) {
+  const double segment_length = forest.calcSegmentLength();
+  if (segment_length == 0.0) return;
+  addBranches(forest.local_root(), segment_length * forest.model().scaling_factor());
+}
+
+
+void BranchFrequencySpectrum::printLocusOutput(OutputBuffer &output) const {
+  output << "BSFS: " << bsfs_ << '\n';
+}
+
+
+// Adds the branches below node, weighted by weight.
+void BranchFrequencySpectrum::addBranches(Node const* node, const double weight) {
+  Node const* children[2] = { node->getLocalChild1(), node->getLocalChild2() };
+  for (Node const* child : children) {
+    if (child == NULL) continue;
+    assert( child->samples_below() > 0 && child->samples_below() <= bsfs_.size() );
+    bsfs_[child->samples_below() - 1] += (node->height() - child->height()) * weight;
+    if (!child->in_sample()) addBranches(child, weight);
+  }
+}
@@ -0,0 +1,60 @@
+/*
+ * scrm is an implementation of the Sequential-Coalescent-with-Recombination Model.
+ * 
+ * Copyright (C) 2013, 2014 Paul R. Staab, Sha (Joe) Zhu, Dirk Metzler and Gerton Lunter
+ * 
+ * This file is part of scrm.
+ * 
+ * scrm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef scrm_src_summary_statistic_branch_frequency_spectrum
+#define scrm_src_summary_statistic_branch_frequency_spectrum
+
+#include <vector>
+
+#include "summary_statistic.h"
+#include "../forest.h"
+
+/**
+ * @brief The site frequency spectrum in terms of branch lengths.
+ *
+ * For each segment, the length of every branch of the local tree, multiplied
+ * with the length of the segment, is added to the bin given by the number of
+ * samples below the branch. This gives the expected SFS without simulating
+ * mutations; multiplying it with the mutation rate per base and unit of time
+ * yields the expected number of mutations in each bin. Branch lengths are 
+ * scaled as in the trees, and the segment lengths are given in bases (or 
+ * relative to the locus length when using relative sequence scaling).
+ */
+class BranchFrequencySpectrum : public SummaryStatistic
+{
+ public:
+  BranchFrequencySpectrum(const size_t sample_size) : bsfs_(sample_size - 1, 0.0) {}
+
+  //Virtual methods
+  void calculate(const Forest &forest);
+  void printLocusOutput(OutputBuffer &output) const;
+  void clear() { std::fill(bsfs_.begin(), bsfs_.end(), 0.0); }
+  BranchFrequencySpectrum* clone() const { return new BranchFrequencySpectrum(*this); }
+
+  std::vector<double> const & bsfs() const { return bsfs_; }
+
+ private:
+  void addBranches(Node const* node, const double weight);
+  std::vector<double> bsfs_;
+};
+
+#endif
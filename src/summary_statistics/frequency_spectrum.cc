@@ -26,18 +26,13 @@ void FrequencySpectrum::calculate(const Forest &forest) {
   if (seg_sites_->position() != forest.next_base()) seg_sites_->calculate(forest);
   assert(seg_sites_->position() == forest.next_base()); 
 
-  size_t haplotype;
-
   for (size_t i = at_mutation_; i < seg_sites_->countMutations(); ++i) { 
-    haplotype = 0;
-    for (size_t j = 0; j < seg_sites_->getHaplotype(i)->size(); ++j) 
-      haplotype += (*(seg_sites_->getHaplotype(i)))[j];
-    sfs_.at(haplotype - 1) += 1; 
+    sfs_.at(seg_sites_->getDerivedCount(i) - 1) += 1; 
   }
 
   at_mutation_ = seg_sites_->countMutations();
 }
 
-void FrequencySpectrum::printLocusOutput(std::ostream &output) const {
-  output << "SFS: " << sfs_ << std::endl;
+void FrequencySpectrum::printLocusOutput(OutputBuffer &output) const {
+  output << "SFS: " << sfs_ << '\n';
 }
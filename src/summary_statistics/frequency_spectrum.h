@@ -38,23 +38,32 @@
 class FrequencySpectrum : public SummaryStatistic
 {
  public:
+#ifdef UNITTEST
+   friend class TestSummaryStatistics;
+#endif
+
    FrequencySpectrum(std::shared_ptr<SegSites> seg_sites, const Model &model) : seg_sites_(seg_sites) {
      sfs_ = std::vector<size_t>(model.sample_size() - 1, 0);
      at_mutation_ = 0;
      //total_sfs_ = std::vector<size_t>(model_.sample_size() - 1, 0);
    }
 
-   FrequencySpectrum(const FrequencySpectrum &sp) : seg_sites_(sp.seg_sites_) { }
+   FrequencySpectrum(const FrequencySpectrum &sp) : 
+     seg_sites_(sp.seg_sites_), sfs_(sp.sfs_), at_mutation_(sp.at_mutation_) { }
 
    //Virtual methods
    void calculate(const Forest &forest);
-   void printLocusOutput(std::ostream &output) const;
+   void printLocusOutput(OutputBuffer &output) const;
    void clear() { 
      for (size_t i = 0; i < sfs_.size(); ++i) sfs_.at(i) = 0;
      at_mutation_ = 0;
    }
    FrequencySpectrum* clone() const { return new FrequencySpectrum(*this); }
    std::vector<size_t> const & sfs() const { return sfs_; }
+   size_t sample_size() const { return sfs_.size() + 1; }
+
+   std::shared_ptr<SegSites> seg_sites() const { return seg_sites_; }
+   void set_seg_sites(std::shared_ptr<SegSites> seg_sites) { seg_sites_ = seg_sites; }
 
  private:
    std::shared_ptr<SegSites> seg_sites_;
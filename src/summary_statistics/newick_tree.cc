@@ -24,18 +24,34 @@
 
 void NewickTree::calculate(const Forest &forest) {
   segment_length_ = forest.calcSegmentLength();
-  if (segment_length_ > 0.0) tree_ = generateTree(forest.local_root(), forest, has_rec_); 
+  if (segment_length_ == 0.0) return;
+
+  // The tree of the last segment contains the buffered subtrees.
+  tree_.swap(last_tree_);
+  tree_.clear();
+  ++generation_;
+  generateTree(forest.local_root(), forest, tree_, has_rec_, NULL, 0); 
+  root_ = forest.local_root();
+
+  // Remove subtrees that are not part of the current tree.
+  if (buffer_.size() > 4 * forest.sample_size()) {
+    size_t start;
+    for (auto it = buffer_.begin(); it != buffer_.end(); ) {
+      if (findSubtree(it->second, start)) ++it;
+      else it = buffer_.erase(it);
+    }
+  }
 }
 
 
-void NewickTree::printSegmentOutput(std::ostream &output) const {
+void NewickTree::printSegmentOutput(OutputBuffer &output) const {
   if (segment_length_ == 0.0) return;
   if (has_rec_) {
     double intpart; // dummy variable for modf
     if (modf(segment_length_, &intpart) == 0.0) output << "[" << (size_t)segment_length_ << "]";
     else output << "[" << segment_length_ << "]";
   }
-  output << tree_ << ";" << std::endl;
+  output << tree_ << ";\n";
 }
 
 
@@ -43,42 +59,86 @@ void NewickTree::printSegmentOutput(std::ostream &output) const {
  * @brief Prints a part of the tree in newick format
  *
  * @param node The root of the subtree that will be printed
- *
- * @return A part of the tree in newick format
+ * @param tree The string to which the subtree is appended. Must be tree_ 
+ *             when use_buffer is true.
+ * @param parent The parent of node, or NULL for the root
+ * @param parent_start The position of the parent's subtree in tree 
  */
-std::string NewickTree::generateTree(Node const* node, const Forest &forest, const bool use_buffer) {
+void NewickTree::generateTree(Node const* node, const Forest &forest, std::string &tree, 
+                              const bool use_buffer, Node const* parent, const size_t parent_start) {
+  if (node->in_sample()) {
+    OutputBuffer::formatInteger(tree, node->label());
+    return;
+  }
+
+  const size_t start = tree.size();
+
   // Use tree from buffer if possible
-  std::map<Node const*, NewickBuffer>::iterator it = buffer_.find(node);
-  if (use_buffer && it != buffer_.end()) {
-    if (it->second.recombination > node->last_change()) {
+  if (use_buffer) {
+    std::unordered_map<Node const*, NewickBuffer>::iterator it = buffer_.find(node);
+    size_t last_start;
+    if (it != buffer_.end() && it->second.recombination > node->last_change() && 
+        findSubtree(it->second, last_start)) {
+      tree.append(last_tree_, last_start, it->second.length);
+      it->second.parent = parent;
+      it->second.parent_version = generation_;
+      it->second.start = start - parent_start;
+
+#ifndef NDEBUG
       // Check that the buffered tree is correct.
-      assert(it->second.tree.compare(generateTree(node, forest, false)) == 0);
-      return it->second.tree;
+      std::string check;
+      generateTree(node, forest, check, false, NULL, 0);
+      assert(tree.compare(start, std::string::npos, check) == 0);
+#endif
+      return;
     }
   }
 
   // Generate a new tree
-  std::stringstream tree;
-  tree.precision(this->precision_);
-  tree.exceptions(std::ios::failbit); 
-
-  if (node->in_sample()) tree << node->label();
-  else { 
-    Node *left = node->getLocalChild1();
-    Node *right = node->getLocalChild2();
-
-    tree << "(" << generateTree(left, forest, use_buffer) << ":" <<
-           (node->height() - left->height()) * forest.model().scaling_factor() <<
-           "," << generateTree(right, forest, use_buffer) << ":" <<
-           (node->height() - right->height()) * forest.model().scaling_factor() << ")";
-
-    // And add to to the buffer
-    if (use_buffer) {
-      NewickBuffer buf = {forest.current_rec(), tree.str()};
-      buffer_[node] = buf; 
-    }
-  }
+  Node *left = node->getLocalChild1();
+  Node *right = node->getLocalChild2();
+
+  tree += "(";
+  generateTree(left, forest, tree, use_buffer, node, start);
+  tree += ":";
+  OutputBuffer::formatDouble(tree, (node->height() - left->height()) * forest.model().scaling_factor(), precision_);
+  tree += ",";
+  generateTree(right, forest, tree, use_buffer, node, start);
+  tree += ":";
+  OutputBuffer::formatDouble(tree, (node->height() - right->height()) * forest.model().scaling_factor(), precision_);
+  tree += ")";
 
-  return tree.str();
+  // And add to to the buffer
+  if (use_buffer) {
+    NewickBuffer buf = {forest.current_rec(), generation_, parent, generation_, 
+                        start - parent_start, tree.size() - start};
+    buffer_[node] = buf; 
+  }
 }
 
+
+/**
+ * @brief Finds the position of a buffered subtree in the tree of the
+ * previous segment.
+ *
+ * Follows the parents in which the subtree was printed up to the root of
+ * the tree, which fails if the subtree of one of them has been regenerated 
+ * since then.
+ *
+ * @return true if the subtree is part of the tree, false otherwise
+ */
+bool NewickTree::findSubtree(const NewickBuffer &buffer, size_t &start) const {
+  start = buffer.start;
+  NewickBuffer const* current = &buffer;
+  std::unordered_map<Node const*, NewickBuffer>::const_iterator it;
+  while (current->parent != NULL) {
+    it = buffer_.find(current->parent);
+    if (it == buffer_.end() || it->second.version != current->parent_version) return false;
+    current = &(it->second);
+    start += current->start;
+  }
+
+  // The subtree at the top must be the whole tree.
+  it = buffer_.find(root_);
+  return it != buffer_.end() && &(it->second) == current;
+}
@@ -26,50 +26,73 @@
 #include <sstream>
 #include <iostream>
 #include <string>
-#include <map>
+#include <unordered_map>
 
 #include "summary_statistic.h"
 #include "../forest.h"
 
 
 /**
- * @brief Save buffered trees along with the recombination number at which
- * they where created. 
+ * @brief Save the location of buffered subtrees along with the recombination 
+ * number at which they where created. 
+ *
+ * The subtrees are not stored on their own, but are part of the tree of the
+ * previous segment. Their position is given relative to the subtree of the
+ * parent node in which they were printed the last time, such that the
+ * positions of all nodes in a subtree remain valid if the subtree is copied 
+ * as a whole.
  */
 struct NewickBuffer {
-  size_t recombination;  ///< The recombination at which the subtree was created.
-  std::string tree;      ///< The subtree itself.
+  size_t recombination;   ///< The recombination at which the subtree was created.
+  size_t version;         ///< The segment in which the subtree was created.
+  Node const* parent;     ///< The node in whose subtree it was printed, or NULL.
+  size_t parent_version;  ///< The version of the parent's subtree at that time.
+  size_t start;           ///< The position relative to the parent's subtree.
+  size_t length;          ///< The length of the subtree.
 };
 
 
 class NewickTree : public SummaryStatistic
 {
  public:
-  NewickTree() : precision_(6), has_rec_(true) {}
-  NewickTree(size_t precision) : precision_(precision), has_rec_(true) {}
+  NewickTree() : precision_(6), has_rec_(true), generation_(0), root_(NULL) {}
+  NewickTree(size_t precision) : 
+      precision_(precision), has_rec_(true), generation_(0), root_(NULL) {}
   NewickTree(size_t precision, bool has_recombination) : 
       precision_(precision), 
-      has_rec_(has_recombination) {}
+      has_rec_(has_recombination),
+      generation_(0),
+      root_(NULL) {}
 
   //Virtual methods
   void calculate(const Forest &forest);
-  void printSegmentOutput(std::ostream &output) const;
+  void printSegmentOutput(OutputBuffer &output) const;
 
   NewickTree* clone() const { return new NewickTree(precision_, has_rec_); };
-  void clear() { buffer_.clear(); }
+  void clear() { 
+    buffer_.clear();
+    root_ = NULL;
+  }
 
  private:
-  std::string generateTree(Node const* node, const Forest &forest, const bool use_buffer);
+  void generateTree(Node const* node, const Forest &forest, std::string &tree, 
+                    const bool use_buffer, Node const* parent, const size_t parent_start);
+  bool findSubtree(const NewickBuffer &buffer, size_t &start) const;
   std::string tree_;
   double segment_length_;
   size_t precision_;
   bool has_rec_;
 
   /**
-   * A map to buffer already created subtrees indexed by their 
-   * root.
+   * A hash map to buffer already created subtrees indexed by their root.
+   * Only the subtrees that are part of the previous segment's tree, which is 
+   * kept in last_tree_, can be reused. The others are removed from time to
+   * time.
    */
-  std::map<Node const*, NewickBuffer> buffer_;
+  std::unordered_map<Node const*, NewickBuffer> buffer_;
+  std::string last_tree_;
+  size_t generation_;
+  Node const* root_;
 };
 
 #endif
@@ -21,21 +21,54 @@
 
 #include "oriented_forest.h"
 
+const size_t OrientedForest::kNoSlot;
+
 void OrientedForest::calculate(const Forest &forest) {
   segment_length_ = forest.calcSegmentLength();
   if (segment_length_ == 0.0) return;
   has_rec_ = forest.model().has_recombination();
 
-  size_t pos = 2*forest.sample_size()-2;
-  generateTreeData(forest.local_root(), pos, 0, forest.model().scaling_factor()); 
+  full_output_ = (last_rec_ == 0);
+  for (size_t pos : changed_) is_changed_[pos] = false;
+  changed_.clear();
+
+  if (incremental_ && !full_output_) {
+    updateSlots(forest);
+  } else {
+    size_t pos = 2*forest.sample_size()-2;
+    generateTreeData(forest.local_root(), pos, 0, forest.model().scaling_factor()); 
+    if (incremental_) initSlots();
+  }
+  last_rec_ = forest.current_rec();
+
+  std::sort(changed_.begin(), changed_.end());
+  assert( checkTreeData(forest) );
 }
 
 
-void OrientedForest::printSegmentOutput(std::ostream &output) const {
+void OrientedForest::printSegmentOutput(OutputBuffer &output) const {
   if (segment_length_ == 0.0) return;
   output << "{" ;
   if (has_rec_) output << "\"length\":" << segment_length_ << ", ";
 
+  if (incremental_ && !full_output_) {
+    // Print only the changed entries, identified by their (1-based) node number.
+    output << "\"changed\":[" ;
+    for (size_t i = 0; i < changed_.size(); ++i) { 
+      output << (i > 0 ? "," : "") << changed_[i] + 1;
+    }
+    output << "], \"parents\":[" ;
+    for (size_t i = 0; i < changed_.size(); ++i) { 
+      output << (i > 0 ? "," : "") << parents_[changed_[i]];
+    }
+    output << "], \"node_times\":[" ;
+    for (size_t i = 0; i < changed_.size(); ++i) { 
+      output << (i > 0 ? "," : "") << heights_[changed_[i]];
+    }
+    output << "]}\n";
+    return;
+  }
+
   // Print parents
   output << "\"parents\":[" ;
   for (int parent : parents_) { 
@@ -49,21 +82,30 @@ void OrientedForest::printSegmentOutput(std::ostream &output) const {
   for (double height : heights_) {
     output << height << ( height != tmrca ? "," : "" );
   }
-  output << "]}" << std::endl;
+  output << "]}\n";
 }
 
 
 void OrientedForest::generateTreeData(Node const* node, size_t &pos, int parent_pos, const double scaling_factor) {
   // Samples have a fixed position in the arrays, given by their label.
   if (node->in_sample()) {
-    heights_.at(node->label()-1) = node->height() * scaling_factor;
-    parents_.at(node->label()-1) = parent_pos;
+    setEntry(node->label()-1, node, parent_pos, node->height() * scaling_factor);
+    return;
+  }
+
+  // The entries of a subtree that has not changed since the last segment are
+  // still valid if it starts at the same position. 
+  const size_t node_pos = pos;
+  const double height = node->height() * scaling_factor;
+  if (last_rec_ > 0 && nodes_.at(pos) == node && 
+      node->last_change() <= last_rec_ && heights_.at(pos) == height) {
+    setEntry(pos, node, parent_pos, height);
+    pos = subtree_end_.at(node_pos);
     return;
   }
 
   // Otherwise take the position given by pos and decrease it.
-  heights_.at(pos) = node->height() * scaling_factor;
-  parents_.at(pos) = parent_pos;
+  setEntry(pos, node, parent_pos, height);
   parent_pos = pos--;
 
   Node* local_child_1 = node->getLocalChild1();
@@ -83,4 +125,169 @@ void OrientedForest::generateTreeData(Node const* node, size_t &pos, int parent_
 
     generateTreeData(local_child_1, pos, parent_pos+1, scaling_factor);
   }
+
+  subtree_end_.at(node_pos) = pos;
+}
+
+
+void OrientedForest::setEntry(const size_t pos, Node const* node, 
+                              const int parent_pos, const double height) {
+  if (!is_changed_[pos] && (nodes_[pos] == NULL || parents_[pos] != parent_pos || 
+                            heights_[pos] != height)) {
+    is_changed_[pos] = true;
+    changed_.push_back(pos);
+  }
+  nodes_[pos] = node;
+  parents_[pos] = parent_pos;
+  heights_[pos] = height;
+}
+
+
+// Builds the slot assignment from a fully generated tree.
+void OrientedForest::initSlots() {
+  slots_.clear();
+  free_slots_.clear();
+  std::fill(children_.begin(), children_.end(), kNoSlot);
+  const size_t sample_size = (nodes_.size() + 1) / 2;
+  for (size_t slot = 0; slot < nodes_.size(); ++slot) {
+    if (slot >= sample_size) slots_[nodes_[slot]] = slot;
+    if (parents_[slot] > 0) addChild(parents_[slot] - 1, slot);
+    else root_slot_ = slot;
+  }
+}
+
+
+// Updates the entries of the nodes that changed since the last segment, 
+// while all other nodes keep their slot.
+void OrientedForest::updateSlots(const Forest &forest) {
+  ++stamp_;
+  updates_.clear();
+  collectUpdates(forest.local_root(), kNoSlot, forest.model().scaling_factor());
+
+  // Nodes which are no longer in the tree were children of a changed node,
+  // or the root. Their slots get free. 
+  if (seen_[root_slot_] != stamp_) removeSlot(root_slot_);
+  for (Update &update : updates_) {
+    if (!update.expanded || update.slot == kNoSlot) continue;
+    for (size_t i = 2*update.slot; i < 2*update.slot+2; ++i) {
+      if (children_[i] != kNoSlot && seen_[children_[i]] != stamp_) removeSlot(children_[i]);
+    }
+  }
+
+  // Assign the free slots to the new nodes
+  for (Update &update : updates_) {
+    if (update.slot != kNoSlot) continue;
+    assert( !free_slots_.empty() );
+    update.slot = free_slots_.back();
+    free_slots_.pop_back();
+    slots_[update.node] = update.slot;
+  }
+  assert( free_slots_.empty() );
+
+  for (Update &update : updates_) {
+    if (update.expanded) {
+      children_[2*update.slot] = kNoSlot;
+      children_[2*update.slot+1] = kNoSlot;
+    }
+  }
+  for (Update &update : updates_) {
+    if (update.parent == kNoSlot) {
+      setEntry(update.slot, update.node, 0, update.height);
+      root_slot_ = update.slot;
+    } else {
+      size_t parent_slot = updates_[update.parent].slot;
+      setEntry(update.slot, update.node, parent_slot + 1, update.height);
+      addChild(parent_slot, update.slot);
+    }
+  }
+}
+
+
+void OrientedForest::collectUpdates(Node const* node, const size_t parent, 
+                                    const double scaling_factor) {
+  Update update = { node, parent, kNoSlot, node->height() * scaling_factor, false };
+  if (node->in_sample()) {
+    update.slot = node->label() - 1;
+  } else {
+    auto it = slots_.find(node);
+    if (it != slots_.end() && heights_[it->second] == update.height) update.slot = it->second;
+  }
+  if (update.slot != kNoSlot) seen_[update.slot] = stamp_;
+
+  // Unchanged subtrees are not traversed.
+  update.expanded = !node->in_sample() && 
+      (update.slot == kNoSlot || node->last_change() > last_rec_);
+  const size_t index = updates_.size();
+  updates_.push_back(update);
+  if (!update.expanded) return;
+
+  Node* local_child_1 = node->getLocalChild1();
+  if (local_child_1 != NULL) collectUpdates(local_child_1, index, scaling_factor);
+  Node* local_child_2 = node->getLocalChild2();
+  if (local_child_2 != NULL) collectUpdates(local_child_2, index, scaling_factor);
+}
+
+
+// Frees the slot of a node that left the tree, together with the ones of its 
+// former children that also left it. 
+void OrientedForest::removeSlot(const size_t slot) {
+  assert( slot >= (nodes_.size() + 1) / 2 );
+  slots_.erase(nodes_[slot]);
+  free_slots_.push_back(slot);
+  for (size_t i = 2*slot; i < 2*slot+2; ++i) {
+    if (children_[i] != kNoSlot && seen_[children_[i]] != stamp_) removeSlot(children_[i]);
+  }
+}
+
+
+void OrientedForest::addChild(const size_t slot, const size_t child) {
+  if (children_[2*slot] == kNoSlot) children_[2*slot] = child;
+  else children_[2*slot+1] = child;
+}
+
+
+// Checks the arrays against the ones generated without reusing subtrees.
+bool OrientedForest::checkTreeData(const Forest &forest) const {
+  if (incremental_ && !full_output_) {
+    size_t count = 0;
+    if (!checkSlots(forest.local_root(), 0, forest.model().scaling_factor(), count) ||
+        count != nodes_.size()) {
+      dout << "Error: Incrementally updated oriented forest is wrong" << std::endl;
+      return false;
+    }
+    return true;
+  }
+
+  OrientedForest full((parents_.size() + 1) / 2);
+  size_t pos = 2*forest.sample_size()-2;
+  full.generateTreeData(forest.local_root(), pos, 0, forest.model().scaling_factor()); 
+  if (full.parents_ != parents_ || full.heights_ != heights_) {
+    dout << "Error: Reused oriented forest entries are outdated" << std::endl;
+    return false;
+  }
+  return true;
+}
+
+
+bool OrientedForest::checkSlots(Node const* node, const int parent_pos, 
+                                const double scaling_factor, size_t &count) const {
+  size_t slot;
+  if (node->in_sample()) {
+    slot = node->label() - 1;
+  } else {
+    auto it = slots_.find(node);
+    if (it == slots_.end()) return false;
+    slot = it->second;
+  }
+  if (nodes_[slot] != node || parents_[slot] != parent_pos || 
+      heights_[slot] != node->height() * scaling_factor) return false;
+  ++count;
+
+  Node* local_child_1 = node->getLocalChild1();
+  if (local_child_1 != NULL && 
+      !checkSlots(local_child_1, slot + 1, scaling_factor, count)) return false;
+  Node* local_child_2 = node->getLocalChild2();
+  if (local_child_2 != NULL && 
+      !checkSlots(local_child_2, slot + 1, scaling_factor, count)) return false;
+  return true;
 }
@@ -26,29 +26,62 @@
 #include <sstream>
 #include <iostream>
 #include <vector>
+#include <algorithm>
+#include <unordered_map>
 
 #include "summary_statistic.h"
 #include "../forest.h"
 
+/**
+ * @brief Prints the local trees in oriented forest format.
+ *
+ * The arrays of the previous segment are kept, and subtrees whose nodes did
+ * not change since then (according to Node::last_change()) keep their
+ * entries without being traversed again. In incremental mode, only the first
+ * segment of a locus is printed in full, and for all further segments only
+ * the entries that changed are printed. To keep these few, each internal node
+ * keeps its number for as long as it is part of the local trees, and the
+ * numbers of nodes that leave the tree are reused for the ones that enter it.
+ * Unlike in the full output, parents can therefore have a lower number than
+ * their children.
+ */
 class OrientedForest : public SummaryStatistic
 {
  public:
-  OrientedForest(const size_t sample_size) {
+  OrientedForest(const size_t sample_size, const bool incremental = false) :
+    incremental_(incremental) {
     parents_ = std::vector<int>(2*sample_size-1, 0);
     heights_ = std::vector<double>(2*sample_size-1, 0.0);
+    nodes_ = std::vector<Node const*>(2*sample_size-1, NULL);
+    subtree_end_ = std::vector<size_t>(2*sample_size-1, 0);
+    is_changed_ = std::vector<bool>(2*sample_size-1, false);
+    children_ = std::vector<size_t>(2*(2*sample_size-1), kNoSlot);
+    seen_ = std::vector<size_t>(2*sample_size-1, 0);
+    stamp_ = 0;
+    clear();
   }
 
   //Virtual methods
   void calculate(const Forest &forest);
-  void printSegmentOutput(std::ostream &output) const;
-  void clear() { }
+  void printSegmentOutput(OutputBuffer &output) const;
+  void clear() { 
+    std::fill(nodes_.begin(), nodes_.end(), (Node const*)NULL);
+    last_rec_ = 0;
+    full_output_ = true;
+    slots_.clear();
+    free_slots_.clear();
+  }
 
   double segment_length() const { return segment_length_; }
   std::vector<int> parents() const { return parents_; }
   std::vector<double> heights() const { return heights_; }
+  bool incremental() const { return incremental_; }
+
+  // The positions of the entries which changed in the last segment
+  std::vector<size_t> const & changed() const { return changed_; }
 
   OrientedForest* clone() const {
-    return new OrientedForest(this->parents_.size());
+    return new OrientedForest((this->parents_.size() + 1) / 2, incremental_);
   }
 
 #ifdef UNITTEST
@@ -58,11 +91,50 @@ class OrientedForest : public SummaryStatistic
  private:
   OrientedForest() {}
   void generateTreeData(Node const* node, size_t &pos, int parent_pos, const double scaling_factor);
+  void setEntry(const size_t pos, Node const* node, const int parent_pos, const double height);
+  bool checkTreeData(const Forest &forest) const;
+
+  // Incremental mode
+  void initSlots();
+  void updateSlots(const Forest &forest);
+  void collectUpdates(Node const* node, const size_t parent, const double scaling_factor);
+  void removeSlot(const size_t slot);
+  void addChild(const size_t slot, const size_t child);
+  bool checkSlots(Node const* node, const int parent_pos, 
+                  const double scaling_factor, size_t &count) const;
 
   std::vector<int> parents_;
   std::vector<double> heights_;
   double segment_length_;
   bool has_rec_;
+
+  // The node at each position and the position after its subtree
+  std::vector<Node const*> nodes_;
+  std::vector<size_t> subtree_end_;
+  size_t last_rec_;
+
+  std::vector<size_t> changed_;
+  std::vector<bool> is_changed_;
+  bool incremental_;
+  bool full_output_;
+
+  // Incremental mode: The slot (position) of each internal node, the slots of
+  // the children in the previous tree and the slots that are free. 
+  static const size_t kNoSlot = static_cast<size_t>(-1);
+  struct Update {
+    Node const* node;
+    size_t parent;  // index of the parent's update
+    size_t slot;
+    double height;
+    bool expanded;  // if the children were visited as well
+  };
+  std::vector<Update> updates_;
+  std::unordered_map<Node const*, size_t> slots_;
+  std::vector<size_t> children_;
+  std::vector<size_t> free_slots_;
+  std::vector<size_t> seen_;
+  size_t stamp_;
+  size_t root_slot_;
 };
 
 #endif
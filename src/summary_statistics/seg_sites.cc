@@ -21,73 +21,236 @@
 
 #include "seg_sites.h"
 
+const size_t SegSites::kNoBranch;
+
 void SegSites::calculate(const Forest &forest) {
   if (forest.current_base() == 0.0) clear();
+  if (sample_size() != forest.model().sample_size()) {
+    assert(countMutations() == 0);
+    set_sample_size(forest.model().sample_size());
+  }
   if (position() == forest.next_base()) return;
   if (position() != forest.current_base()) 
     throw std::logic_error("Problem simulating seg_sites: Did we skip a forest segment?");
 
+  // Sample the positions of the mutations on the sequence and on the local 
+  // tree. The points on the tree are drawn as offsets into the local tree in
+  // the order of Forest::samplePoint(node, length_left), and are placed on the
+  // branches afterwards.
+  const double tree_length = forest.getLocalTreeLength();
+  const size_t first_mutation = countMutations();
+  offsets_.clear();
+
   double position_at = forest.current_base();
-  position_at += forest.random_generator()->sampleExpo(forest.getLocalTreeLength() * forest.model().mutation_rate());
+  position_at += forest.random_generator()->sampleExpo(tree_length * forest.model().mutation_rate());
 
   while (position_at < forest.next_base()) {
-    TreePoint mutation = forest.samplePoint();
-    heights_.push_back(mutation.height() / (4 * forest.model().default_pop_size()));
-    haplotypes_.push_back(getHaplotypes(mutation, forest));
+    offsets_.push_back(forest.random_generator()->sample() * tree_length);
     if (forest.model().getSequenceScaling() == absolute) {
       positions_.push_back(position_at);
     } else {
       positions_.push_back(position_at / forest.model().loci_length());
     }
-    position_at += forest.random_generator()->sampleExpo(forest.getLocalTreeLength() * forest.model().mutation_rate());
+    position_at += forest.random_generator()->sampleExpo(tree_length * forest.model().mutation_rate());
   }
 
+  if (offsets_.size() * 8 >= forest.model().sample_size()) {
+    placeMutations(forest, first_mutation);
+  } else {
+    // For few mutations, descending the tree for each of them is faster.
+    for (double offset : offsets_) {
+      TreePoint mutation = forest.samplePoint(forest.local_root(), offset);
+      heights_.push_back(mutation.height() / (4 * forest.model().default_pop_size()));
+      derived_.push_back(mutation.base_node()->samples_below());
+      if (store_haplotypes_) addHaplotype(mutation);
+    }
+  }
   set_position(forest.next_base());
 }
 
 
-void SegSites::printLocusOutput(std::ostream &output) const {
-  if ( transpose_ ) {
-    output << "transposed segsites: " << countMutations() << std::endl;
+/**
+ * @brief Places the mutations of a segment on the local tree and calculates
+ * their haplotypes.
+ *
+ * The local branches are indexed in the order in which
+ * Forest::samplePoint(node, length_left) traverses them, so that each point is located on the same branch by a 
+ * binary search over the branches' starting points. In this order, the 
+ * branches below a node form a continuous range. For segments with many 
+ * mutations, the haplotypes of all branches are calculated in a single 
+ * bottom-up pass, with each branch's bitset combining the ones of its 
+ * children. Otherwise, the samples in the range of the mutated branch are 
+ * collected for each mutation.
+ */
+void SegSites::placeMutations(const Forest &forest, const size_t first_mutation) {
+  branches_.clear();
+  branch_starts_.clear();
+  double offset = 0.0;
+  indexBranches(forest.local_root(), true, offset, kNoBranch);
+  assert( !branches_.empty() );
+
+  const double scaling = 4 * forest.model().default_pop_size();
+  mutation_branches_.clear();
+  for (double mutation_offset : offsets_) {
+    assert( 0 < mutation_offset && mutation_offset < forest.getLocalTreeLength() );
+    size_t branch = std::upper_bound(branch_starts_.begin(), branch_starts_.end(), 
+                                     mutation_offset) - branch_starts_.begin() - 1;
+    Node const* node = branches_[branch].node;
+    double relative_height = std::min(mutation_offset - branch_starts_[branch], 
+                                      node->height_above());
+    heights_.push_back((node->height() + relative_height) / scaling);
+    derived_.push_back(node->samples_below());
+    mutation_branches_.push_back(branch);
+  }
+  if (!store_haplotypes_) return;
+
+  haplotypes_.resize(haplotypes_.size() + offsets_.size() * words_per_site_, 0);
+  uint64_t* haplotype = haplotypes_.data() + first_mutation * words_per_site_;
+
+  if (offsets_.size() * 64 >= branches_.size()) {
+    // Calculate the bitsets of all branches, children before parents
+    branch_words_.assign(branches_.size() * words_per_site_, 0);
+    for (size_t i = branches_.size(); i-- > 0; ) {
+      uint64_t* words = branch_words_.data() + i * words_per_site_;
+      if (branches_[i].node->in_sample()) {
+        const size_t sample = branches_[i].node->label() - 1;
+        words[sample / 64] |= (uint64_t)1 << (sample % 64);
+      }
+      if (branches_[i].parent == kNoBranch) continue;
+      uint64_t* parent_words = branch_words_.data() + branches_[i].parent * words_per_site_;
+      for (size_t w = 0; w < words_per_site_; ++w) parent_words[w] |= words[w];
+    }
+
+    for (size_t branch : mutation_branches_) {
+      std::copy_n(branch_words_.data() + branch * words_per_site_, words_per_site_, haplotype);
+      haplotype += words_per_site_;
+    }
+  } else {
+    for (size_t branch : mutation_branches_) {
+      for (size_t i = branch; i < branches_[branch].end; ++i) {
+        if (!branches_[i].node->in_sample()) continue;
+        const size_t sample = branches_[i].node->label() - 1;
+        haplotype[sample / 64] |= (uint64_t)1 << (sample % 64);
+      }
+      haplotype += words_per_site_;
+    }
+  }
+
+#ifndef NDEBUG
+  for (size_t i = first_mutation; i < countMutations(); ++i) {
+    size_t derived = 0;
+    uint64_t const* words = haplotypes_.data() + i * words_per_site_;
+    for (size_t w = 0; w < words_per_site_; ++w) derived += popcount(words[w]);
+    assert( derived == derived_[i] );
+  }
+#endif
+}
+
+
+// Adds the local branches below node in the order of
+// Forest::samplePoint(node, length_left).
+void SegSites::indexBranches(Node const* node, const bool is_root, 
+                             double &offset, const size_t parent) {
+  const size_t index = branches_.size();
+  if (!is_root) {
+    Branch branch = { node, 0, parent };
+    branches_.push_back(branch);
+    branch_starts_.push_back(offset);
+    offset += node->height_above();
+  }
+
+  if (!node->in_sample()) {
+    Node const* first_child = node->first_child();
+    Node const* second_child = node->second_child();
+    const size_t self = is_root ? kNoBranch : index;
+    if (first_child != NULL && first_child->local()) indexBranches(first_child, false, offset, self);
+    if (second_child != NULL && second_child->local()) indexBranches(second_child, false, offset, self);
+  }
+
+  if (!is_root) branches_[index].end = branches_.size();
+}
+
+
+void SegSites::printLocusOutput(OutputBuffer &output) const {
+  if ( binary_ ) {
+    printBinaryOutput(output);
+  } else if ( transpose_ ) {
+    output << "transposed segsites: " << countMutations() << '\n';
     if ( countMutations() == 0 ) return;
     output << "position time";
-    for (size_t i = 0; i < haplotypes_.at(0).size(); i++){
+    for (size_t i = 0; i < sample_size(); i++){
       output << " " << i+1;
     }
     output <<"\n";
   
-    for (size_t j = 0; j < haplotypes_.size(); j++){
+    std::string line(2 * sample_size(), ' ');
+    for (size_t j = 0; j < countMutations(); j++){
       output << positions_[j] << " " << heights_[j];
-      for (size_t i = 0; i < haplotypes_.at(0).size(); i++){
-        output << " " << haplotypes_[j][i];
+      for (size_t i = 0; i < sample_size(); i++){
+        line[2*i+1] = '0' + getAllele(j, i);
       }
-      output <<"\n";
+      output << line << "\n";
     }
   } else {
-    output << "segsites: " << countMutations() << std::endl;
+    output << "segsites: " << countMutations() << '\n';
     if ( countMutations() == 0 ) return;
-    output << "positions: " << positions_ << std::endl;
+    output << "positions: " << positions_ << '\n';
   
-    for (size_t i = 0; i < haplotypes_.at(0).size(); i++){
-      for (size_t j = 0; j < haplotypes_.size(); j++){
-        output << haplotypes_[j][i];
+    // Print the haplotypes sample-wise, assembling each line before writing it.
+    std::string line(countMutations(), '0');
+    for (size_t i = 0; i < sample_size(); i++){
+      const size_t word = i / 64, bit = i % 64;
+      uint64_t const* haplotype = haplotypes_.data() + word;
+      for (size_t j = 0; j < countMutations(); j++){
+        line[j] = '0' + ((*haplotype >> bit) & 1);
+        haplotype += words_per_site_;
       }
-      output <<"\n";
+      output << line << "\n";
     }
   }
 }
 
 
-std::valarray<bool> SegSites::getHaplotypes(TreePoint mutation, const Forest &forest) {
-  std::valarray<bool> haplotype(forest.model().sample_size());
+void SegSites::printBinaryOutput(OutputBuffer &output) const {
+  output << "binary segsites:\n";
+  const uint64_t header[3] = { countMutations(), sample_size(), (uint64_t)output.precision() };
+  output.write(header, sizeof(header));
+  if ( countMutations() == 0 ) return;
+  output.write(positions_.data(), countMutations() * sizeof(double));
+
+  // Transpose the haplotypes into sample-wise rows.
+  const size_t row_words = (countMutations() + 63) / 64;
+  std::vector<uint64_t> row(row_words);
+  for (size_t i = 0; i < sample_size(); i++){
+    const size_t word = i / 64, bit = i % 64;
+    uint64_t const* haplotype = haplotypes_.data() + word;
+    std::fill(row.begin(), row.end(), 0);
+    for (size_t j = 0; j < countMutations(); j++){
+      row[j / 64] |= ((*haplotype >> bit) & 1) << (j % 64);
+      haplotype += words_per_site_;
+    }
+    output.write(row.data(), row_words * sizeof(uint64_t));
+  }
+}
+
+
+void SegSites::addHaplotype(const TreePoint &mutation) {
+  haplotypes_.resize(haplotypes_.size() + words_per_site_, 0);
+  uint64_t* haplotype = &haplotypes_.back() + 1 - words_per_site_;
   traversal(mutation.base_node(), haplotype);
-  return haplotype;
+
+#ifndef NDEBUG
+  size_t derived = 0;
+  for (size_t w = 0; w < words_per_site_; ++w) derived += popcount(haplotype[w]);
+  assert( derived == mutation.base_node()->samples_below() );
+#endif
 }
 
 
-void SegSites::traversal(Node const* node, std::valarray<bool> &haplotype) const {
+void SegSites::traversal(Node const* node, uint64_t* haplotype) const {
   if (node->in_sample()) {
-    haplotype[node->label()-1]=1;
+    const size_t i = node->label() - 1;
+    haplotype[i / 64] |= (uint64_t)1 << (i % 64);
     return;
   }
   
@@ -25,16 +25,42 @@
 
 #include <sstream>
 #include <iostream>
-#include <valarray>
+#include <vector>
+#include <cstdint>
+#include <stdexcept>
+#include <algorithm>
 
 #include "summary_statistic.h"
 #include "../forest.h"
 #include "../tree_point.h"
 
+/**
+ * @brief Simulates the segregating sites of a locus.
+ *
+ * The haplotypes of all mutations are stored as bitsets in one contiguous
+ * buffer of 64-bit words. Each mutation occupies words_per_site() consecutive
+ * words, in which the bit of sample i is bit i % 64 of word i / 64.
+ * Additionally, the number of samples carrying the derived allele is stored
+ * for each mutation. Statistics that need only this number can disable the
+ * storage of the haplotypes using set_store_haplotypes(false).
+ *
+ * With binary output, each locus is printed as the line "binary segsites:"
+ * followed by a header of three 64-bit unsigned integers (the number of
+ * segregating sites S, the number of samples n and the output precision),
+ * the S positions as 64-bit floats, and n haplotype rows. Each row consists
+ * of (S + 63) / 64 64-bit words, in which the allele of mutation j is bit
+ * j % 64 of word j / 64. All numbers are in the byte order of the machine.
+ */
 class SegSites : public SummaryStatistic
 {
  public:
-  SegSites( ) { set_position(0.0); set_transpose(false);}
+  SegSites( ) { 
+    set_position(0.0); 
+    set_transpose(false); 
+    set_binary(false); 
+    set_store_haplotypes(true);
+    set_sample_size(0); 
+  }
   ~SegSites() {}
 
 #ifdef UNITTEST
@@ -43,13 +69,15 @@ class SegSites : public SummaryStatistic
 
   //Virtual methods
   void calculate(const Forest &forest);
-  void printLocusOutput(std::ostream &output) const;
+  void printLocusOutput(OutputBuffer &output) const;
 
   SegSites* clone() const { return new SegSites(*this); }
 
   void clear() { 
     positions_.clear();
+    heights_.clear();
     haplotypes_.clear();  
+    derived_.clear();
     set_position(0.0);
   };
 
@@ -57,24 +85,75 @@ class SegSites : public SummaryStatistic
 
   double position() const { return position_; };
   std::vector<double> const* positions() const { return &positions_; };
+  std::vector<double> const* heights() const { return &heights_; };
+
+  size_t sample_size() const { return sample_size_; }
+  size_t words_per_site() const { return words_per_site_; }
+
+  // Returns the words_per_site() words of the haplotype of a mutation.
+  uint64_t const* getHaplotypeWords(const size_t mutation) const {
+    if (mutation >= countMutations()) 
+      throw std::out_of_range("SegSites: Mutation does not exist");
+    if (!store_haplotypes_) 
+      throw std::logic_error("SegSites: Haplotypes are not stored");
+    return haplotypes_.data() + mutation * words_per_site_;
+  }
+
+  // Returns the number of samples that carry the derived allele of a mutation.
+  size_t getDerivedCount(const size_t mutation) const {
+    return derived_.at(mutation);
+  }
 
-  std::valarray<bool> const* getHaplotype(const size_t mutation) const {
-    return &(haplotypes_.at(mutation));
+  bool getAllele(const size_t mutation, const size_t sample) const {
+    return (getHaplotypeWords(mutation)[sample / 64] >> (sample % 64)) & 1;
   }
+
   void set_transpose(const bool transpose) { transpose_ = transpose; };
   bool get_transpose() const { return transpose_; }
 
+  void set_binary(const bool binary) { binary_ = binary; };
+  bool binary() const { return binary_; }
+
+  void set_store_haplotypes(const bool store) { store_haplotypes_ = store; };
+  bool store_haplotypes() const { return store_haplotypes_; }
+
  private:
-  std::valarray<bool> getHaplotypes(TreePoint mutation, const Forest &Forest); 
+  void addHaplotype(const TreePoint &mutation); 
+  void placeMutations(const Forest &forest, const size_t first_mutation);
+  void indexBranches(Node const* node, const bool is_root, double &offset, const size_t parent);
+  void printBinaryOutput(OutputBuffer &output) const;
 
   std::vector<double> positions_;
   std::vector<double> heights_;
-  std::vector<std::valarray<bool>> haplotypes_;	
-  void traversal(Node const* node, std::valarray<bool> &haplotype) const;
+  std::vector<uint64_t> haplotypes_;	
+  std::vector<size_t> derived_;
+
+  // Buffers for placing the mutations of a segment on the local tree
+  struct Branch {
+    Node const* node;
+    size_t end;     // The index after the last branch below this one
+    size_t parent;  // The index of the parent branch
+  };
+  static const size_t kNoBranch = static_cast<size_t>(-1);
+  std::vector<Branch> branches_;
+  std::vector<double> branch_starts_;
+  std::vector<double> offsets_;
+  std::vector<size_t> mutation_branches_;
+  std::vector<uint64_t> branch_words_;
+  void traversal(Node const* node, uint64_t* haplotype) const;
 
   void set_position(const double position) { position_ = position; };
+  void set_sample_size(const size_t sample_size) {
+    sample_size_ = sample_size;
+    words_per_site_ = (sample_size + 63) / 64;
+  }
+
   double position_;
   bool transpose_;
+  bool binary_;
+  bool store_haplotypes_;
+  size_t sample_size_;
+  size_t words_per_site_;
 };
 
 #endif
@@ -0,0 +1,85 @@
+/*
+ * scrm is an implementation of the Sequential-Coalescent-with-Recombination Model.
+ * 
+ * Copyright (C) 2013, 2014 Paul R. Staab, Sha (Joe) Zhu, Dirk Metzler and Gerton Lunter
+ * 
+ * This file is part of scrm.
+ * 
+ * scrm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "sfs_statistics.h"
+
+#include <cmath>
+#include <limits>
+
+void SfsStatistic::printLocusOutput(OutputBuffer &output) const {
+  std::vector<double> values;
+  getValues(values);
+  output << name() << ": ";
+  if (size() == 1) output << values.at(0) << '\n';
+  else output << values << '\n';
+}
+
+
+size_t SfsStatistic::segsites() const {
+  size_t segsites = 0;
+  for (size_t count : sfs_->sfs()) segsites += count;
+  return segsites;
+}
+
+
+double SfsStatistic::calcPi() const {
+  const size_t n = sfs_->sample_size();
+  double pi = 0.0;
+  for (size_t i = 1; i < n; ++i) pi += (double)(i * (n - i)) * sfs_->sfs()[i - 1];
+  return pi / (n * (n - 1) / 2.0);
+}
+
+
+double SfsStatistic::calcThetaW() const {
+  double a1 = 0.0;
+  for (size_t i = 1; i < sfs_->sample_size(); ++i) a1 += 1.0 / i;
+  return segsites() / a1;
+}
+
+
+double SfsStatistic::calcTajimasD() const {
+  const double n = sfs_->sample_size();
+  const double S = segsites();
+  if (S == 0) return std::numeric_limits<double>::quiet_NaN();
+
+  double a1 = 0.0, a2 = 0.0;
+  for (size_t i = 1; i < sfs_->sample_size(); ++i) {
+    a1 += 1.0 / i;
+    a2 += 1.0 / ((double)i * i);
+  }
+  const double b1 = (n + 1) / (3 * (n - 1));
+  const double b2 = 2 * (n * n + n + 3) / (9 * n * (n - 1));
+  const double c1 = b1 - 1 / a1;
+  const double c2 = b2 - (n + 2) / (a1 * n) + a2 / (a1 * a1);
+  const double e1 = c1 / a1;
+  const double e2 = c2 / (a1 * a1 + a2);
+
+  return (calcPi() - S / a1) / std::sqrt(e1 * S + e2 * S * (S - 1));
+}
+
+
+void NormalizedSFS::getValues(std::vector<double> &values) const {
+  const double S = segsites();
+  for (size_t count : frequency_spectrum()->sfs()) {
+    values.push_back(S == 0 ? std::numeric_limits<double>::quiet_NaN() : count / S);
+  }
+}
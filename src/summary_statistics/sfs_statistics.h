@@ -0,0 +1,125 @@
+/*
+ * scrm is an implementation of the Sequential-Coalescent-with-Recombination Model.
+ * 
+ * Copyright (C) 2013, 2014 Paul R. Staab, Sha (Joe) Zhu, Dirk Metzler and Gerton Lunter
+ * 
+ * This file is part of scrm.
+ * 
+ * scrm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef scrm_src_summary_statistic_sfs_statistics
+#define scrm_src_summary_statistic_sfs_statistics
+
+#include <string>
+#include <vector>
+#include <memory>
+
+#include "summary_statistic.h"
+#include "frequency_spectrum.h"
+
+/**
+ * @brief Base class for statistics that are calculated from the site
+ * frequency spectrum of a locus.
+ *
+ * The frequency spectrum, and the segregating sites it is based on, can be
+ * shared between multiple statistics. It is calculated when needed, which
+ * does not require it to be a summary statistic of its own.
+ */
+class SfsStatistic : public SummaryStatistic
+{
+ public:
+  SfsStatistic(std::shared_ptr<FrequencySpectrum> sfs) : sfs_(sfs) {}
+  virtual ~SfsStatistic() {}
+
+  //Virtual methods
+  void calculate(const Forest &forest) { sfs_->calculate(forest); }
+  void printLocusOutput(OutputBuffer &output) const;
+  void clear() { sfs_->clear(); }
+  virtual SfsStatistic* clone() const =0;
+
+  // The name of the statistic, the number of its values and the values for 
+  // the current locus, which are appended to values.
+  virtual std::string name() const =0;
+  virtual size_t size() const { return 1; }
+  virtual void getValues(std::vector<double> &values) const =0;
+
+  std::shared_ptr<FrequencySpectrum> frequency_spectrum() const { return sfs_; }
+  void set_frequency_spectrum(std::shared_ptr<FrequencySpectrum> sfs) { sfs_ = sfs; }
+
+  size_t segsites() const;
+  double calcPi() const;
+  double calcThetaW() const;
+  double calcTajimasD() const;
+
+ private:
+  std::shared_ptr<FrequencySpectrum> sfs_;
+};
+
+
+/**
+ * @brief The average number of pairwise differences between the samples.
+ */
+class NucleotideDiversity : public SfsStatistic 
+{
+ public:
+  NucleotideDiversity(std::shared_ptr<FrequencySpectrum> sfs) : SfsStatistic(sfs) {}
+  std::string name() const { return "pi"; }
+  void getValues(std::vector<double> &values) const { values.push_back(calcPi()); }
+  NucleotideDiversity* clone() const { return new NucleotideDiversity(*this); }
+};
+
+
+/**
+ * @brief Watterson's estimator of theta.
+ */
+class WattersonsTheta : public SfsStatistic 
+{
+ public:
+  WattersonsTheta(std::shared_ptr<FrequencySpectrum> sfs) : SfsStatistic(sfs) {}
+  std::string name() const { return "thetaW"; }
+  void getValues(std::vector<double> &values) const { values.push_back(calcThetaW()); }
+  WattersonsTheta* clone() const { return new WattersonsTheta(*this); }
+};
+
+
+/**
+ * @brief Tajima's D. Is not defined (nan) for loci without segregating sites.
+ */
+class TajimasD : public SfsStatistic 
+{
+ public:
+  TajimasD(std::shared_ptr<FrequencySpectrum> sfs) : SfsStatistic(sfs) {}
+  std::string name() const { return "D"; }
+  void getValues(std::vector<double> &values) const { values.push_back(calcTajimasD()); }
+  TajimasD* clone() const { return new TajimasD(*this); }
+};
+
+
+/**
+ * @brief The site frequency spectrum divided by the number of segregating
+ * sites. Is not defined (nan) for loci without segregating sites.
+ */
+class NormalizedSFS : public SfsStatistic 
+{
+ public:
+  NormalizedSFS(std::shared_ptr<FrequencySpectrum> sfs) : SfsStatistic(sfs) {}
+  std::string name() const { return "nSFS"; }
+  size_t size() const { return frequency_spectrum()->sfs().size(); }
+  void getValues(std::vector<double> &values) const;
+  NormalizedSFS* clone() const { return new NormalizedSFS(*this); }
+};
+
+#endif
@@ -0,0 +1,132 @@
+/*
+ * scrm is an implementation of the Sequential-Coalescent-with-Recombination Model.
+ * 
+ * Copyright (C) 2013, 2014 Paul R. Staab, Sha (Joe) Zhu, Dirk Metzler and Gerton Lunter
+ * 
+ * This file is part of scrm.
+ * 
+ * scrm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "statistics_table.h"
+
+#include <cmath>
+#include <limits>
+
+#include "../forest.h"
+
+StatisticsTable::StatisticsTable(const StatisticsTable &table) : 
+    print_rows_(table.print_rows_), print_means_(table.print_means_),
+    names_(table.names_), values_(table.values_), counts_(table.counts_), 
+    means_(table.means_), sum_squares_(table.sum_squares_) {
+  // Copy the frequency spectrum and the segregating sites, such that the copy
+  // is independent of the original.
+  std::shared_ptr<SegSites> seg_sites(table.sfs_->seg_sites()->clone());
+  sfs_ = std::shared_ptr<FrequencySpectrum>(table.sfs_->clone());
+  sfs_->set_seg_sites(seg_sites);
+
+  for (auto statistic : table.statistics_) {
+    statistics_.push_back(std::shared_ptr<SfsStatistic>(statistic->clone()));
+    statistics_.back()->set_frequency_spectrum(sfs_);
+  }
+}
+
+
+void StatisticsTable::addStatistic(std::shared_ptr<SfsStatistic> statistic) {
+  assert( statistic->frequency_spectrum() == sfs_ );
+  statistics_.push_back(statistic);
+  if (statistic->size() == 1) {
+    names_.push_back(statistic->name());
+  } else {
+    for (size_t i = 1; i <= statistic->size(); ++i) {
+      names_.push_back(statistic->name() + "_" + std::to_string(i));
+    }
+  }
+  counts_.resize(names_.size(), 0);
+  means_.resize(names_.size(), 0.0);
+  sum_squares_.resize(names_.size(), 0.0);
+}
+
+
+void StatisticsTable::calculate(const Forest &forest) {
+  sfs_->calculate(forest);
+  if (forest.next_base() < forest.model().loci_length()) return;
+
+  // The locus is complete
+  size_t segsites = 0;
+  for (size_t count : sfs_->sfs()) segsites += count;
+  values_.clear();
+  values_.push_back(segsites);
+  for (auto statistic : statistics_) statistic->getValues(values_);
+  assert( values_.size() == names_.size() );
+
+  for (size_t i = 0; i < values_.size(); ++i) {
+    if (std::isnan(values_[i])) continue;
+    ++counts_[i];
+    double delta = values_[i] - means_[i];
+    means_[i] += delta / counts_[i];
+    sum_squares_[i] += delta * (values_[i] - means_[i]);
+  }
+}
+
+
+void StatisticsTable::clear() {
+  sfs_->seg_sites()->clear();
+  sfs_->clear();
+  values_.clear();
+}
+
+
+std::vector<double> StatisticsTable::variances() const {
+  std::vector<double> variances(sum_squares_.size());
+  for (size_t i = 0; i < variances.size(); ++i) {
+    if (counts_[i] < 2) variances[i] = std::numeric_limits<double>::quiet_NaN();
+    else variances[i] = sum_squares_[i] / (counts_[i] - 1);
+  }
+  return variances;
+}
+
+
+void StatisticsTable::printRunHeader(OutputBuffer &output) const {
+  if (!print_rows_) return;
+  output << '\n';
+  for (size_t i = 0; i < names_.size(); ++i) {
+    output << (i > 0 ? "\t" : "") << names_[i];
+  }
+  output << '\n';
+}
+
+
+void StatisticsTable::printLocusOutput(OutputBuffer &output) const {
+  if (!print_rows_) return;
+  for (size_t i = 0; i < values_.size(); ++i) {
+    if (i > 0) output << '\t';
+    output << values_[i];
+  }
+  output << '\n';
+}
+
+
+void StatisticsTable::printRunOutput(OutputBuffer &output) const {
+  if (!print_means_) return;
+  std::vector<double> variances = this->variances();
+  output << "\nstatistic\tloci\tmean\tvariance\n";
+  for (size_t i = 0; i < names_.size(); ++i) {
+    output << names_[i] << '\t' << counts_[i] << '\t';
+    if (counts_[i] == 0) output << std::numeric_limits<double>::quiet_NaN();
+    else output << means_[i];
+    output << '\t' << variances[i] << '\n';
+  }
+}
@@ -0,0 +1,87 @@
+/*
+ * scrm is an implementation of the Sequential-Coalescent-with-Recombination Model.
+ * 
+ * Copyright (C) 2013, 2014 Paul R. Staab, Sha (Joe) Zhu, Dirk Metzler and Gerton Lunter
+ * 
+ * This file is part of scrm.
+ * 
+ * scrm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef scrm_src_summary_statistic_statistics_table
+#define scrm_src_summary_statistic_statistics_table
+
+#include <string>
+#include <vector>
+#include <memory>
+
+#include "summary_statistic.h"
+#include "sfs_statistics.h"
+
+/**
+ * @brief Collects the number of segregating sites and a number of SFS based
+ * statistics for each locus.
+ *
+ * The values can be printed as a single row per locus, preceded by a header
+ * with the names of the columns. Additionally or alternatively, the mean 
+ * and variance of each column across all loci can be printed at the end of 
+ * the run. They are calculated using Welford's algorithm without storing the
+ * values of the loci. Undefined (nan) values are not included in them.
+ *
+ * The table owns the statistics, the frequency spectrum and the segregating 
+ * sites it uses.
+ */
+class StatisticsTable : public SummaryStatistic
+{
+ public:
+  StatisticsTable(std::shared_ptr<FrequencySpectrum> sfs, 
+                  const bool print_rows, const bool print_means) : 
+    sfs_(sfs), print_rows_(print_rows), print_means_(print_means),
+    names_(1, "segsites"), counts_(1, 0), means_(1, 0.0), sum_squares_(1, 0.0) {}
+  StatisticsTable(const StatisticsTable &table);
+
+  //Virtual methods
+  void calculate(const Forest &forest);
+  void printRunHeader(OutputBuffer &output) const;
+  void printLocusOutput(OutputBuffer &output) const;
+  void printRunOutput(OutputBuffer &output) const;
+  void clear();
+  StatisticsTable* clone() const { return new StatisticsTable(*this); }
+
+  void addStatistic(std::shared_ptr<SfsStatistic> statistic);
+
+  std::vector<std::string> const & names() const { return names_; }
+  std::vector<double> const & values() const { return values_; }
+  std::vector<size_t> const & counts() const { return counts_; }
+  std::vector<double> const & means() const { return means_; }
+  std::vector<double> variances() const;
+
+ private:
+  std::shared_ptr<FrequencySpectrum> sfs_;
+  std::vector<std::shared_ptr<SfsStatistic> > statistics_;
+  bool print_rows_;
+  bool print_means_;
+
+  // The name and value of each column
+  std::vector<std::string> names_;
+  std::vector<double> values_;
+
+  // The running statistics of each column
+  std::vector<size_t> counts_;
+  std::vector<double> means_;
+  std::vector<double> sum_squares_;
+};
+
+#endif
@@ -26,6 +26,8 @@
 #include <iostream>
 #include <ostream>
 
+#include "../output_buffer.h"
+
 class Forest;
 
 class SummaryStatistic 
@@ -39,8 +41,12 @@ class SummaryStatistic
    virtual SummaryStatistic* clone() const =0; 
 
    // Optional methods
-   virtual void printLocusOutput(std::ostream &output) const { (void) output; };
-   virtual void printSegmentOutput(std::ostream &output) const { (void) output; };
+   virtual void printLocusOutput(OutputBuffer &output) const { (void) output; };
+   virtual void printSegmentOutput(OutputBuffer &output) const { (void) output; };
+
+   // Output before the first and after the last locus of a run
+   virtual void printRunHeader(OutputBuffer &output) const { (void) output; };
+   virtual void printRunOutput(OutputBuffer &output) const { (void) output; };
 };
 
 #endif
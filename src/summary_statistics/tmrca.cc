@@ -28,7 +28,7 @@ void TMRCA::calculate(const Forest &forest) {
 }
 
 
-void TMRCA::printLocusOutput(std::ostream &output) const {
+void TMRCA::printLocusOutput(OutputBuffer &output) const {
   for (size_t i = 0; i < tmrca_.size(); ++i) {
     output << "time:\t" << tmrca_.at(i) << " \t" << tree_length_.at(i) << "\n";
   }
@@ -0,0 +1,252 @@
+/*
+ * scrm is an implementation of the Sequential-Coalescent-with-Recombination Model.
+ * 
+ * Copyright (C) 2013, 2014 Paul R. Staab, Sha (Joe) Zhu, Dirk Metzler and Gerton Lunter
+ * 
+ * This file is part of scrm.
+ * 
+ * scrm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#include "tree_sequence.h"
+
+const size_t TreeSequence::kNoParent;
+
+void TreeSequence::clear() {
+  node_times_.clear();
+  node_ids_.clear();
+  edges_.clear();
+  parents_.clear();
+  lefts_.clear();
+  children_.clear();
+  in_tree_.clear();
+  last_seen_.clear();
+  former_children_.clear();
+  sample_size_ = 0;
+  segment_ = 0;
+  last_rec_ = 0;
+  root_id_ = kNoParent;
+  position_ = 0.0;
+}
+
+
+void TreeSequence::calculate(const Forest &forest) {
+  // Reserve the first ids for the samples
+  if (node_times_.empty()) {
+    sample_size_ = forest.sample_size();
+    node_times_.resize(forest.sample_size(), 0.0);
+    parents_.resize(forest.sample_size(), kNoParent);
+    lefts_.resize(forest.sample_size(), 0.0);
+    children_.resize(2 * forest.sample_size(), kNoParent);
+    in_tree_.resize(forest.sample_size(), false);
+    last_seen_.resize(forest.sample_size(), 0);
+  }
+
+  ++segment_;
+  const double left = scalePosition(forest.current_base(), forest);
+  position_ = scalePosition(forest.next_base(), forest);
+
+  Node const* root = forest.local_root();
+  const size_t root_id = getNodeId(root, forest);
+  if (root_id != root_id_ && root_id_ != kNoParent) former_children_.push_back(root_id_);
+  if (parents_[root_id] != kNoParent) closeEdge(root_id, left);
+  last_seen_[root_id] = segment_;
+  if (!in_tree_[root_id] || root->last_change() > last_rec_) {
+    update(root, root_id, left, forest);
+  }
+
+  // Close the edges of nodes that are no longer part of the local tree
+  for (size_t node_id : former_children_) {
+    if (in_tree_[node_id] && last_seen_[node_id] != segment_) removeNode(node_id, left);
+  }
+  former_children_.clear();
+  root_id_ = root_id;
+  last_rec_ = forest.current_rec();
+
+  assert( checkEdges(forest) );
+}
+
+
+// Updates the edges below a node that is new or whose subtree changed.
+void TreeSequence::update(Node const* node, const size_t node_id, 
+                          const double left, const Forest &forest) {
+  in_tree_[node_id] = true;
+  if (node->in_sample()) return;
+
+  Node const* children[2] = { node->getLocalChild1(), node->getLocalChild2() };
+  for (size_t i = 0; i < 2; ++i) {
+    assert( children[i] != NULL );
+    size_t child_id = getNodeId(children[i], forest);
+    if (children_[2*node_id+i] != kNoParent) former_children_.push_back(children_[2*node_id+i]);
+    children_[2*node_id+i] = child_id;
+
+    // Replace the edge above the child if its parent changed
+    if (parents_[child_id] != node_id) {
+      if (parents_[child_id] != kNoParent) closeEdge(child_id, left);
+      parents_[child_id] = node_id;
+      lefts_[child_id] = left;
+    }
+    last_seen_[child_id] = segment_;
+
+    // Unchanged subtrees keep their edges
+    if (!in_tree_[child_id] || children[i]->last_change() > last_rec_) {
+      update(children[i], child_id, left, forest);
+    }
+  }
+}
+
+
+// Closes the edges of a node that left the tree, and the ones of its former
+// children that also left it.
+void TreeSequence::removeNode(const size_t node_id, const double right) {
+  in_tree_[node_id] = false;
+  if (parents_[node_id] != kNoParent) closeEdge(node_id, right);
+  for (size_t i = 2*node_id; i < 2*node_id+2; ++i) {
+    size_t child_id = children_[i];
+    children_[i] = kNoParent;
+    if (child_id != kNoParent && in_tree_[child_id] && last_seen_[child_id] != segment_) {
+      removeNode(child_id, right);
+    }
+  }
+}
+
+
+/**
+ * @brief Returns the id of a node in the node table.
+ *
+ * Nodes are identified by their address and their time. Nodes which are
+ * moved to a different time, or whose memory is reused for a new node, get
+ * a new id.
+ */
+size_t TreeSequence::getNodeId(Node const* node, const Forest &forest) {
+  const double time = node->height() * forest.model().scaling_factor();
+  if (node->in_sample()) {
+    node_times_[node->label() - 1] = time;
+    return node->label() - 1;
+  }
+
+  auto it = node_ids_.find(node);
+  if (it != node_ids_.end() && node_times_[it->second] == time) return it->second;
+
+  const size_t id = node_times_.size();
+  node_times_.push_back(time);
+  parents_.push_back(kNoParent);
+  lefts_.push_back(0.0);
+  children_.resize(2 * (id + 1), kNoParent);
+  in_tree_.push_back(false);
+  last_seen_.push_back(0);
+  node_ids_[node] = id;
+  return id;
+}
+
+
+void TreeSequence::closeEdge(const size_t child, const double right) {
+  // Edges of segments without length are dropped, as are the segments in
+  // the output of trees.
+  if (lefts_[child] < right) {
+    Edge edge = { lefts_[child], right, parents_[child], child };
+    edges_.push_back(edge);
+  }
+  parents_[child] = kNoParent;
+}
+
+
+// Scales a position on the locus in the same way as the positions of the
+// segregating sites.
+double TreeSequence::scalePosition(const double base, const Forest &forest) const {
+  if (forest.model().getSequenceScaling() == absolute) return base;
+  return base / forest.model().loci_length();
+}
+
+
+// Returns all edges, where the ones that are still open end at the current
+// position. They are sorted by the time of the parent, the parent, the child
+// and the left end, as required by tskit.
+std::vector<TreeSequence::Edge> TreeSequence::edges() const {
+  std::vector<Edge> edges = edges_;
+  for (size_t child = 0; child < parents_.size(); ++child) {
+    if (parents_[child] != kNoParent && lefts_[child] < position_) {
+      Edge edge = { lefts_[child], position_, parents_[child], child };
+      edges.push_back(edge);
+    }
+  }
+
+  std::sort(edges.begin(), edges.end(), [this](const Edge &a, const Edge &b) {
+    if (node_times_[a.parent] != node_times_[b.parent]) return node_times_[a.parent] < node_times_[b.parent];
+    if (a.parent != b.parent) return a.parent < b.parent;
+    if (a.child != b.child) return a.child < b.child;
+    return a.left < b.left;
+  });
+  return edges;
+}
+
+
+// Checks that the open edges are the branches of the local tree, and that no
+// other nodes are part of it.
+bool TreeSequence::checkEdges(const Forest &forest) const {
+  size_t count = 0;
+  if (!checkEdges(forest.local_root(), forest, count)) return false;
+  if (parents_[root_id_] != kNoParent || 
+      (size_t)std::count(in_tree_.begin(), in_tree_.end(), true) != count) {
+    dout << "Error: The tree sequence contains additional edges" << std::endl;
+    return false;
+  }
+  return true;
+}
+
+bool TreeSequence::checkEdges(Node const* node, const Forest &forest, size_t &count) const {
+  size_t node_id;
+  if (node->in_sample()) {
+    node_id = node->label() - 1;
+  } else {
+    auto it = node_ids_.find(node);
+    if (it == node_ids_.end()) return false;
+    node_id = it->second;
+  }
+  if (!in_tree_[node_id] || node_times_[node_id] != node->height() * forest.model().scaling_factor()) {
+    dout << "Error: Node " << node << " is missing in the tree sequence" << std::endl;
+    return false;
+  }
+  ++count;
+  if (node->in_sample()) return true;
+
+  Node const* children[2] = { node->getLocalChild1(), node->getLocalChild2() };
+  for (Node const* child : children) {
+    if (!checkEdges(child, forest, count)) return false;
+    size_t child_id = child->in_sample() ? child->label() - 1 : node_ids_.find(child)->second;
+    if (parents_[child_id] != node_id) {
+      dout << "Error: Wrong edge above " << child << " in the tree sequence" << std::endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+
+void TreeSequence::printLocusOutput(OutputBuffer &output) const {
+  output << "nodes: " << node_times_.size() << '\n';
+  output << "id\tis_sample\ttime\n";
+  for (size_t i = 0; i < node_times_.size(); ++i) {
+    output << i << '\t' << (i < sample_size_ ? "1\t" : "0\t") << node_times_[i] << '\n';
+  }
+
+  std::vector<Edge> edges = this->edges();
+  output << "edges: " << edges.size() << '\n';
+  output << "left\tright\tparent\tchild\n";
+  for (const Edge &edge : edges) {
+    output << edge.left << '\t' << edge.right << '\t' 
+           << edge.parent << '\t' << edge.child << '\n';
+  }
+}
@@ -0,0 +1,117 @@
+/*
+ * scrm is an implementation of the Sequential-Coalescent-with-Recombination Model.
+ * 
+ * Copyright (C) 2013, 2014 Paul R. Staab, Sha (Joe) Zhu, Dirk Metzler and Gerton Lunter
+ * 
+ * This file is part of scrm.
+ * 
+ * scrm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+#ifndef scrm_src_summary_statistic_tree_sequence
+#define scrm_src_summary_statistic_tree_sequence
+
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <unordered_map>
+
+#include "summary_statistic.h"
+#include "../forest.h"
+
+/**
+ * @brief Records the genealogies of a locus as a tree sequence.
+ *
+ * Instead of printing every local tree, the genealogies are stored in a table
+ * of nodes and a table of edges. Each edge connects a parent with a child node
+ * on an interval of the sequence. A new edge is only created when the parent of
+ * a node changes from one segment to the next, such that the size of the output
+ * grows with the number of changed branches instead of with the number of
+ * segments times the sample size.
+ *
+ * Like the oriented forest, the local trees are not traversed completely for
+ * each segment. Subtrees whose nodes did not change since the previous
+ * segment (according to Node::last_change()) keep their edges and are
+ * skipped, and the edges of nodes that left the tree are closed starting
+ * from their former parents.
+ *
+ * The tables are printed at the end of each locus in the tab-separated text
+ * format of tskit, with the edges sorted by the time of their parent. The
+ * nodes with ids 0 to n-1 are the samples, and node times are given in units
+ * of 4N0 generations. Sequence positions are scaled as the positions of the
+ * segregating sites: relative to the locus length between 0 and 1 by default,
+ * and in bases with `-SC abs`.
+ */
+class TreeSequence : public SummaryStatistic
+{
+ public:
+  struct Edge {
+    double left;
+    double right;
+    size_t parent;
+    size_t child;
+  };
+
+  TreeSequence() { clear(); }
+
+  //Virtual methods
+  void calculate(const Forest &forest);
+  void printLocusOutput(OutputBuffer &output) const;
+  void clear();
+
+  TreeSequence* clone() const { return new TreeSequence(); }
+
+  const std::vector<double> & node_times() const { return node_times_; }
+  std::vector<Edge> edges() const;
+
+#ifdef UNITTEST
+  friend class TestSummaryStatistics;
+#endif
+
+ private:
+  size_t getNodeId(Node const* node, const Forest &forest);
+  void update(Node const* node, const size_t node_id, const double left, const Forest &forest);
+  void removeNode(const size_t node_id, const double right);
+  void closeEdge(const size_t child, const double right);
+  double scalePosition(const double base, const Forest &forest) const;
+  bool checkEdges(const Forest &forest) const;
+  bool checkEdges(Node const* node, const Forest &forest, size_t &count) const;
+
+  static const size_t kNoParent = -1;
+
+  std::vector<double> node_times_;
+  std::unordered_map<Node const*, size_t> node_ids_;
+  std::vector<Edge> edges_;
+
+  // The edges that reach to the current segment, indexed by the id of the
+  // child, and the ids of the children of each node in the current tree.
+  std::vector<size_t> parents_;
+  std::vector<double> lefts_;
+  std::vector<size_t> children_;
+  std::vector<bool> in_tree_;
+
+  // The segment in which a node was last visited, and the former children of
+  // the visited nodes which may have left the tree.
+  std::vector<size_t> last_seen_;
+  std::vector<size_t> former_children_;
+
+  size_t sample_size_;
+  size_t segment_;
+  size_t last_rec_;
+  size_t root_id_;
+  double position_;
+};
+
+#endif
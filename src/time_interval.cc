@@ -86,6 +86,7 @@ void TimeIntervalIterator::next() {
   if (this->inside_node_ != NULL) {
     this->current_interval_.start_height_ = inside_node_->height();
     this->inside_node_ = NULL;
+    STATS(++forest_->stats_.time_intervals);
     return;
   }
 
@@ -139,6 +140,7 @@ void TimeIntervalIterator::next() {
   this->current_interval_ = TimeInterval(this, 
                                          start_height, 
                                          current_time_);
+  STATS(++forest_->stats_.time_intervals);
 }
 
 void TimeIntervalIterator::searchContemporariesBottomUp(Node* node, const bool use_buffer) {
@@ -153,6 +155,7 @@ void TimeIntervalIterator::searchContemporariesBottomUp(Node* node, const bool u
       auto end = contemporaries()->buffer_end(pop);
       for (auto it = contemporaries()->buffer_begin(pop); it != end; ++it) {
         assert(!(*it)->is_root());
+        STATS(++forest_->stats_.contemporaries_scanned);
         //std::cout << "Checking " << *it << std::endl;
         // Prune the node if needed
         tmp_child_1_ = (*it);
@@ -182,11 +185,41 @@ void TimeIntervalIterator::searchContemporariesBottomUp(Node* node, const bool u
     start_node = start_node->next();
     assert( start_node->height() >= contemporaries()->buffer_time() );
   } else {
+#ifdef SCRM_BRANCH_INDEX
+    if (forest_->nodes()->has_branch_index()) {
+      // Without a buffer, look up the branches that cross the node's height in
+      // the branch index of each population rather than iterating over all
+      // nodes below it. Merging the branches by height processes them in the
+      // order of the nodes, as the loop below does.
+      tmp_branches_.clear();
+      for (size_t pop = 0; pop < model()->population_number(); ++pop) {
+        size_t pop_start = tmp_branches_.size();
+        forest_->nodes()->findBranchesCrossing(node, node->height(), pop, tmp_branches_);
+        std::inplace_merge(tmp_branches_.begin(), tmp_branches_.begin() + pop_start,
+                           tmp_branches_.end(), [](Node const* a, Node const* b) {
+                             return a->height() < b->height(); });
+      }
+      for (Node* branch : tmp_branches_) {
+        STATS(++forest_->stats_.contemporaries_scanned);
+        tmp_child_1_ = branch->first_child();
+        if (forest_->pruneNodeIfNeeded(branch)) {
+          // Maybe a child of the node became a contemporary by removing the node
+          if ( tmp_child_1_ != NULL && tmp_child_1_->parent_height() > node->height() ) { 
+            this->contemporaries()->add(tmp_child_1_);
+          }
+        } else {
+          this->contemporaries()->add(branch);
+        }
+      }
+      return;
+    }
+#endif
     start_node = forest()->nodes()->first(); 
   }
 
   for (NodeIterator ni = forest_->nodes()->iterator(start_node); *ni != node; ++ni) {
     assert(ni.good());
+    STATS(++forest_->stats_.contemporaries_scanned);
 
     // Check if *ni is a contemporary of node 
     if ( (*ni)->parent_height() > node->height() ) {
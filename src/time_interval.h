@@ -125,6 +125,9 @@ class TimeIntervalIterator {
 
   // Temporary values
   Node *tmp_child_1_, *tmp_child_2_, *tmp_prev_node_;
+#ifdef SCRM_BRANCH_INDEX
+  std::vector<Node*> tmp_branches_;
+#endif
 };
 
 /** 
@@ -111,6 +111,27 @@ echo "Testing Variable Rates"
  test_scrm 3 2 -r 2 100 -t 5 -st 10 10 -sr 20 5 -st 30 1 -sr 40 0 -st 50 20 -T || exit 1
 echo ""
 
+echo "Testing Parallel Loci"
+ test_scrm 10 20 -r 5 200 -t 5 -oSFS -threads 2 || exit 1
+ test_scrm 8 10 -r 5 200 -T -threads 3 || exit 1
+echo ""
+
+echo "Testing Binary Output"
+ make scrm_bin2ms || exit 1
+ for args in "5 10 -t 5" "70 3 -t 100 -r 10 1000 -L -oSFS -p 10" "4 3 -t 0.01" "8 10 -r 5 200 -t 5 -T -threads 2"; do
+   echo -n " scrm $args -o bin "
+   for i in `seq 1 10`; do
+     echo -n "."
+     if ! cmp -s <(./scrm $args -seed $i) <(./scrm $args -o bin -seed $i | ./scrm_bin2ms); then
+       echo ""
+       echo "Converted binary output of \"./scrm $args -o bin -seed $i\" differs."
+       exit 1
+     fi
+   done
+   echo " done."
+ done
+echo ""
+
 echo "Various Edge Cases"
  test_scrm 6 1 -I 2 3 3 0.5 -r 1 100 -es 0 2 0.5 -ej 1 3 1 -t 1  || exit 1
  test_scrm 10 1 -es 1.0 1 0.5 -ej 1.0 2 1 || exit 1
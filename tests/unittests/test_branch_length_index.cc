@@ -0,0 +1,89 @@
+#include <cppunit/TestCase.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "../../src/branch_length_index.h"
+
+class TestBranchLengthIndex : public CppUnit::TestCase {
+
+  CPPUNIT_TEST_SUITE( TestBranchLengthIndex );
+
+  CPPUNIT_TEST( testSetAndGet );
+  CPPUNIT_TEST( testFind );
+  CPPUNIT_TEST( testClear );
+
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+  void testSetAndGet() {
+    BranchLengthIndex index;
+    CPPUNIT_ASSERT_EQUAL( 0.0, index.total() );
+    CPPUNIT_ASSERT_EQUAL( 0.0, index.get(5) );
+
+    index.set(5, 2.0);
+    index.set(3, 1.5);
+    CPPUNIT_ASSERT_EQUAL( 2.0, index.get(5) );
+    CPPUNIT_ASSERT_EQUAL( 1.5, index.get(3) );
+    CPPUNIT_ASSERT_EQUAL( 3.5, index.total() );
+
+    index.set(5, 0.5);
+    CPPUNIT_ASSERT_EQUAL( 2.0, index.total() );
+
+    // The index grows for large slots
+    index.set(5000, 4.0);
+    CPPUNIT_ASSERT_EQUAL( 4.0, index.get(5000) );
+    CPPUNIT_ASSERT_EQUAL( 1.5, index.get(3) );
+    CPPUNIT_ASSERT_EQUAL( 6.0, index.total() );
+  }
+
+  void testFind() {
+    BranchLengthIndex index;
+    index.set(1, 1.0);
+    index.set(4, 2.0);
+    index.set(700, 3.0);
+
+    double length = 0.5;
+    CPPUNIT_ASSERT_EQUAL( (size_t)1, index.find(length) );
+    CPPUNIT_ASSERT_EQUAL( 0.5, length );
+
+    length = 1.0;
+    CPPUNIT_ASSERT_EQUAL( (size_t)4, index.find(length) );
+    CPPUNIT_ASSERT_EQUAL( 0.0, length );
+
+    length = 4.5;
+    CPPUNIT_ASSERT_EQUAL( (size_t)700, index.find(length) );
+    CPPUNIT_ASSERT_EQUAL( 1.5, length );
+
+    // Points behind the last branch stay on it
+    length = 6.0;
+    CPPUNIT_ASSERT_EQUAL( (size_t)700, index.find(length) );
+    CPPUNIT_ASSERT( length < 3.0 );
+
+    // Empty branches are never found
+    index.set(4, 0.0);
+    length = 1.0;
+    CPPUNIT_ASSERT_EQUAL( (size_t)700, index.find(length) );
+    CPPUNIT_ASSERT_EQUAL( 0.0, length );
+  }
+
+  void testClear() {
+    BranchLengthIndex index;
+    index.set(1, 1.0);
+    index.set(300, 2.0);
+    index.clear();
+    CPPUNIT_ASSERT_EQUAL( 0.0, index.total() );
+    CPPUNIT_ASSERT_EQUAL( 0.0, index.get(300) );
+
+    // Only the used slots are reset, but all sums above them
+    index.set(2, 1.0);
+    index.set(200, 3.0);
+    index.clear();
+    index.set(400, 0.5);
+    CPPUNIT_ASSERT_EQUAL( 0.0, index.get(2) );
+    CPPUNIT_ASSERT_EQUAL( 0.0, index.get(200) );
+    CPPUNIT_ASSERT_EQUAL( 0.5, index.total() );
+    double length = 0.25;
+    CPPUNIT_ASSERT_EQUAL( (size_t)400, index.find(length) );
+  }
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION( TestBranchLengthIndex );
@@ -11,9 +11,11 @@ class TestContemporariesContainer : public CppUnit::TestCase {
 
   CPPUNIT_TEST( add );
   CPPUNIT_TEST( remove );
+  CPPUNIT_TEST( removeWithBuffer );
   CPPUNIT_TEST( clear );
   CPPUNIT_TEST( iterator );
   CPPUNIT_TEST( sample );
+  CPPUNIT_TEST( sampleLarge );
   CPPUNIT_TEST( buffer );
   CPPUNIT_TEST( empty );
 
@@ -70,7 +72,7 @@ class TestContemporariesContainer : public CppUnit::TestCase {
     CPPUNIT_ASSERT_EQUAL( (size_t)2, cc.size(2) );
 
     // Set
-    cc = ContemporariesContainer(3, 1000, rg);
+    cc = ContemporariesContainer(3, 1000, rg, true);
     CPPUNIT_ASSERT_EQUAL( (size_t)0, cc.size(0) );
     CPPUNIT_ASSERT_EQUAL( (size_t)0, cc.size(1) );
     CPPUNIT_ASSERT_EQUAL( (size_t)0, cc.size(2) );
@@ -128,7 +130,7 @@ class TestContemporariesContainer : public CppUnit::TestCase {
     CPPUNIT_ASSERT_EQUAL( (size_t)0, cc.size(2) );
 
     // Set
-    cc = ContemporariesContainer(3, 1000, rg);
+    cc = ContemporariesContainer(3, 1000, rg, true);
     cc.add(node1);
     cc.add(node2);
     cc.add(node3);
@@ -158,6 +160,34 @@ class TestContemporariesContainer : public CppUnit::TestCase {
     CPPUNIT_ASSERT_EQUAL( (size_t)0, cc.size(2) );
   }
 
+  void removeWithBuffer() {
+    ContemporariesContainer cc = ContemporariesContainer(3, 10, rg);
+    node1->set_population(2);
+    cc.add(node1);
+    cc.add(node3);
+    cc.add(node4);
+
+    // Removing a node from the middle keeps the other ones
+    cc.remove(node1);
+    CPPUNIT_ASSERT_EQUAL( (size_t)2, cc.size(2) );
+    cc.remove(node1);
+    CPPUNIT_ASSERT_EQUAL( (size_t)2, cc.size(2) );
+    cc.remove(node4);
+    CPPUNIT_ASSERT_EQUAL( (size_t)1, cc.size(2) );
+    CPPUNIT_ASSERT( *cc.begin(2) == node3 );
+
+    // Nodes that are only in the buffer are not removed from the
+    // current contemporaries
+    cc.add(node4);
+    cc.buffer(5);
+    cc.add(node1);
+    cc.remove(node4);
+    CPPUNIT_ASSERT_EQUAL( (size_t)1, cc.size(2) );
+    CPPUNIT_ASSERT( *cc.begin(2) == node1 );
+    cc.remove(node1);
+    CPPUNIT_ASSERT_EQUAL( (size_t)0, cc.size(2) );
+  }
+
   void clear() {
     ContemporariesContainer cc = ContemporariesContainer(3, 10, rg);
     cc.add(node1);
@@ -170,7 +200,7 @@ class TestContemporariesContainer : public CppUnit::TestCase {
     CPPUNIT_ASSERT_EQUAL( (size_t)0, cc.size(1) );
     CPPUNIT_ASSERT_EQUAL( (size_t)0, cc.size(2) );
 
-    cc = ContemporariesContainer(3, 1000, rg);
+    cc = ContemporariesContainer(3, 1000, rg, true);
     cc.add(node1);
     cc.add(node2);
     cc.add(node3);
@@ -210,7 +240,7 @@ class TestContemporariesContainer : public CppUnit::TestCase {
     CPPUNIT_ASSERT_EQUAL((size_t)4, count);
 
     // Set
-    cc = ContemporariesContainer(3, 1000, rg);
+    cc = ContemporariesContainer(3, 1000, rg, true);
     cc.add(node1);
     cc.add(node2);
     cc.add(node3);
@@ -259,7 +289,7 @@ class TestContemporariesContainer : public CppUnit::TestCase {
     CPPUNIT_ASSERT( 0.49 < count && count < 0.51 );
 
     // Set
-    cc = ContemporariesContainer(3, 1000, rg);
+    cc = ContemporariesContainer(3, 1000, rg, true);
     cc.add(node1);
     cc.add(node2);
     cc.add(node3);
@@ -280,6 +310,24 @@ class TestContemporariesContainer : public CppUnit::TestCase {
     CPPUNIT_ASSERT( 0.49 < count && count < 0.51 );
   }
 
+  void sampleLarge() {
+    ContemporariesContainer cc = ContemporariesContainer(1, 2000, rg);
+    CPPUNIT_ASSERT( !cc.use_set() );
+
+    std::vector<Node*> nodes;
+    for (size_t i = 0; i < 2000; ++i) {
+      nodes.push_back(nc->createNode(i));
+      cc.add(nodes.back());
+    }
+    for (size_t i = 0; i < 2000; i += 2) cc.remove(nodes[i]);
+    CPPUNIT_ASSERT_EQUAL( (size_t)1000, cc.size(0) );
+
+    // Only the remaining nodes are sampled
+    for (size_t i = 0; i < 10000; ++i) {
+      CPPUNIT_ASSERT( (size_t)cc.sample(0)->height() % 2 == 1 );
+    }
+  }
+
   void buffer() {
     // Vector
     ContemporariesContainer cc = ContemporariesContainer(3, 10, rg);
@@ -325,7 +373,7 @@ class TestContemporariesContainer : public CppUnit::TestCase {
     CPPUNIT_ASSERT_EQUAL((size_t)0, count);
 
     // Set
-    cc = ContemporariesContainer(3, 1000, rg);
+    cc = ContemporariesContainer(3, 1000, rg, true);
     cc.add(node1);
     cc.add(node2);
     cc.add(node3);
@@ -386,7 +434,7 @@ class TestContemporariesContainer : public CppUnit::TestCase {
     CPPUNIT_ASSERT( !cc.empty() );
 
     // Set
-    cc = ContemporariesContainer(3, 1000, rg);
+    cc = ContemporariesContainer(3, 1000, rg, true);
     CPPUNIT_ASSERT( cc.empty() );
     cc.add(node1);
     CPPUNIT_ASSERT( !cc.empty() );
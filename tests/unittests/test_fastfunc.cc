@@ -10,6 +10,7 @@ class TestFastFunc : public CppUnit::TestCase {
 
   CPPUNIT_TEST( testlog );
   CPPUNIT_TEST( testexp );
+  CPPUNIT_TEST( testblocklog );
 
   CPPUNIT_TEST_SUITE_END();
 
@@ -54,6 +55,24 @@ class TestFastFunc : public CppUnit::TestCase {
       CPPUNIT_ASSERT(upper_bound < true_exp * (1.0 + 0.06148));
     }
   }
+
+  void testblocklog() {
+    MersenneTwister rg(5);
+    double values[1000], logs[1000];
+    rg.sample(values, 1000);
+    values[0] = 1.0;
+    values[1] = 0.5;
+    values[2] = 1e-300;
+    values[3] = std::nextafter(1.0, 0.0);
+    FastFunc::blocklog(values, logs, 1000);
+
+    // The logarithm is exact up to the last bit
+    for (size_t i = 0; i < 1000; ++i) {
+      double truelog = log(values[i]);
+      CPPUNIT_ASSERT( std::abs(logs[i] - truelog) <= std::abs(truelog) * 2.3e-16 );
+    }
+    CPPUNIT_ASSERT_EQUAL( 0.0, logs[0] );
+  }
 };
 
 //Uncomment this to activate the test
@@ -1,6 +1,7 @@
 #include <cppunit/extensions/HelperMacros.h>
 
 #include "../../src/forest.h"
+#include "../../src/param.h"
 #include "../../src/random/constant_generator.h"
 #include "../../src/random/mersenne_twister.h"
 #include "../../src/event.h"
@@ -26,6 +27,10 @@ class TestForest : public CppUnit::TestCase {
   CPPUNIT_TEST( testSampleEvent );
   CPPUNIT_TEST( testGetNodeState );
   CPPUNIT_TEST( testCut );
+  CPPUNIT_TEST( testUpdateAbove );
+#ifdef SCRM_STATS
+  CPPUNIT_TEST( testStats );
+#endif
   CPPUNIT_TEST( testImplementCoalescence );
   CPPUNIT_TEST( testBuildInitialTree );
   CPPUNIT_TEST( testImplementRecombination );
@@ -103,8 +108,8 @@ class TestForest : public CppUnit::TestCase {
   void testCalcRate() {
     TimeIntervalIterator tii(forest, forest->nodes()->at(0));
     double pop_size = 2*forest->model().population_size(0);
-    Node *node1 = new Node(0.1);
-    Node *node2 = new Node(0.2);
+    Node *node1 = forest->nodes()->createNode(0.1);
+    Node *node2 = forest->nodes()->createNode(0.2);
 
     forest->set_active_node(0, node1);
     forest->set_active_node(1, node2);
@@ -172,9 +177,6 @@ class TestForest : public CppUnit::TestCase {
     //CPPUNIT_ASSERT_EQUAL( 0.0/pop_size, forest_2pop->rates_[2] );
     CPPUNIT_ASSERT_EQUAL( (size_t)1, forest_2pop->active_nodes_timelines_[0] );
     CPPUNIT_ASSERT_EQUAL( (size_t)1, forest_2pop->active_nodes_timelines_[1] );
-
-    delete node1;
-    delete node2;
   }
 
   void testCalcRateWithArachicSamples() {
@@ -664,6 +666,103 @@ class TestForest : public CppUnit::TestCase {
     CPPUNIT_ASSERT_EQUAL( 3.5, single_branch->height() );
   }
 
+  void testUpdateAbove() {
+    Node* leaf1 = forest->nodes()->at(0);
+    Node* node12 = forest->nodes()->at(4);
+    Node* root = forest->nodes()->at(8);
+#ifdef SCRM_STATS
+    Stats stats = forest->stats();
+#endif
+
+    // Nothing changed, so the update stops at the first node
+    size_t root_change = root->last_change();
+    size_t node12_change = node12->last_change();
+    forest->current_rec_ = 3;
+    forest->updateAbove(leaf1);
+    CPPUNIT_ASSERT_EQUAL( 2.0, node12->length_below() );
+    CPPUNIT_ASSERT_EQUAL( node12_change, node12->last_change() );
+    CPPUNIT_ASSERT_EQUAL( root_change, root->last_change() );
+#ifdef SCRM_STATS
+    CPPUNIT_ASSERT_EQUAL( stats.update_above_calls + 1, forest->stats().update_above_calls );
+    CPPUNIT_ASSERT_EQUAL( stats.update_above_nodes + 1, forest->stats().update_above_nodes );
+    CPPUNIT_ASSERT_EQUAL( stats.update_above_stops + 1, forest->stats().update_above_stops );
+#endif
+
+    // Changing the height of node12 changes the invariants up to the root
+    forest->current_rec_ = 5;
+    forest->nodes()->move(node12, 2.0);
+    forest->updateAbove(node12);
+    CPPUNIT_ASSERT_EQUAL( 4.0, node12->length_below() );
+    CPPUNIT_ASSERT_EQUAL( 25.0, root->length_below() );
+    CPPUNIT_ASSERT_EQUAL( (size_t)5, node12->last_change() );
+    CPPUNIT_ASSERT_EQUAL( (size_t)5, root->last_change() );
+    CPPUNIT_ASSERT( forest->checkTree() );
+#ifdef SCRM_STATS
+    CPPUNIT_ASSERT_EQUAL( stats.update_above_calls + 2, forest->stats().update_above_calls );
+    CPPUNIT_ASSERT_EQUAL( stats.update_above_nodes + 3, forest->stats().update_above_nodes );
+    CPPUNIT_ASSERT_EQUAL( stats.update_above_stops + 1, forest->stats().update_above_stops );
+
+    // A second update finds no changes
+    forest->updateAbove(node12);
+    CPPUNIT_ASSERT_EQUAL( stats.update_above_nodes + 4, forest->stats().update_above_nodes );
+    CPPUNIT_ASSERT_EQUAL( stats.update_above_stops + 2, forest->stats().update_above_stops );
+#endif
+
+    // Above the local root, nodes are made non-local up to the first node
+    // that already is non-local.
+    Node* above1 = forest->nodes()->createNode(11);
+    Node* above2 = forest->nodes()->createNode(12);
+    Node* top = forest->nodes()->createNode(13);
+    forest->addNodeToTree(above1, NULL, root, NULL);
+    forest->addNodeToTree(above2, NULL, above1, NULL);
+    forest->addNodeToTree(top, NULL, above2, NULL);
+    above2->make_nonlocal(1);
+    forest->updateAbove(above1, true);
+    CPPUNIT_ASSERT( !above1->local() );
+    CPPUNIT_ASSERT( top->local() );
+
+    // An unknown primary root is searched above the local root
+    forest->set_primary_root(NULL);
+    CPPUNIT_ASSERT( forest->primary_root() == top );
+  }
+
+#ifdef SCRM_STATS
+  void testStats() {
+    Model model = Param("10 3 -r 5 1000").parse();
+    Forest frst(&model, rg);
+    size_t segments = 0;
+    for (size_t i = 0; i < model.loci_number(); ++i) {
+      frst.buildInitialTree();
+      while (frst.next_base() < model.loci_length()) frst.sampleNextGenealogy();
+      segments += frst.segment_count();
+      frst.clear();
+    }
+
+    const Stats &stats = frst.stats();
+    CPPUNIT_ASSERT_EQUAL( (size_t)3, stats.loci );
+    CPPUNIT_ASSERT_EQUAL( segments, stats.segments );
+    CPPUNIT_ASSERT_EQUAL( segments - 3, stats.recombinations + stats.rate_changes );
+    CPPUNIT_ASSERT( stats.tree_changes <= stats.recombinations );
+    CPPUNIT_ASSERT( stats.time_intervals > 0 );
+    CPPUNIT_ASSERT( stats.coalescences + stats.pw_coalescences > 0 );
+    CPPUNIT_ASSERT_EQUAL( (size_t)0, stats.migrations );
+    CPPUNIT_ASSERT( stats.max_nodes >= 19 );
+    CPPUNIT_ASSERT( stats.update_above_nodes >= stats.update_above_calls );
+    CPPUNIT_ASSERT( stats.seconds[Stats::genealogies] > 0.0 );
+
+    Stats sum;
+    sum += stats;
+    sum += stats;
+    CPPUNIT_ASSERT_EQUAL( 2 * stats.segments, sum.segments );
+    CPPUNIT_ASSERT_EQUAL( stats.max_nodes, sum.max_nodes );
+
+    std::ostringstream json;
+    stats.printJson(json, 1.0);
+    CPPUNIT_ASSERT( json.str().find("\"loci\": 3,") != std::string::npos );
+    CPPUNIT_ASSERT( json.str().find("\"total\": 1.000000}") != std::string::npos );
+  }
+#endif
+
   void testImplementRecombination() {
     Node* new_root = forest->cut(TreePoint(forest->nodes()->at(4), 3.5, false));
     TimeIntervalIterator tii(forest, new_root);
@@ -772,8 +871,10 @@ class TestForest : public CppUnit::TestCase {
   }
 
   void testSamplePoint() {
-    rg->set_seed(1234);
+    rg->set_seed(12345);
     forest->createScaledExampleTree();
+    CPPUNIT_ASSERT( forest->checkBranchLengths() );
+    CPPUNIT_ASSERT( areSame(forest->getLocalTreeLength(), forest->branch_lengths_.total()) );
 
     TreePoint point;
     int n0 = 0, n1 = 0, n2 = 0, n3 = 0,
@@ -798,6 +899,31 @@ class TestForest : public CppUnit::TestCase {
     CPPUNIT_ASSERT(  9800 <= n3 && n3 <= 10200 ); // expected 10000
     CPPUNIT_ASSERT( 89000 <= n4 && n4 <= 91000 ); // expected 90000
     CPPUNIT_ASSERT( 69000 <= n5 && n5 <= 71000 ); // expected 70000
+
+    // The branches are ordered like in a pre-order traversal
+    forest->createExampleTree();
+    Node* node12 = forest->nodes()->at(4);
+    Node* node34 = forest->nodes()->at(5);
+    point = forest->samplePoint(forest->local_root(), 0.5);
+    CPPUNIT_ASSERT_EQUAL( node12, point.base_node() );
+    CPPUNIT_ASSERT_EQUAL( 1.5, point.height() );
+    point = forest->samplePoint(forest->local_root(), 9.5);
+    CPPUNIT_ASSERT_EQUAL( node12->first_child(), point.base_node() );
+    point = forest->samplePoint(forest->local_root(), 10.5);
+    CPPUNIT_ASSERT_EQUAL( node12->second_child(), point.base_node() );
+    point = forest->samplePoint(forest->local_root(), 11.5);
+    CPPUNIT_ASSERT_EQUAL( node34, point.base_node() );
+    CPPUNIT_ASSERT_EQUAL( 3.5, point.height() );
+    point = forest->samplePoint(forest->local_root(), 21.5);
+    CPPUNIT_ASSERT_EQUAL( node34->second_child(), point.base_node() );
+    CPPUNIT_ASSERT_EQUAL( 0.5, point.height() );
+
+    // Below a node, its own branch comes first
+    point = forest->samplePoint(node34, 6.0);
+    CPPUNIT_ASSERT_EQUAL( node34, point.base_node() );
+    point = forest->samplePoint(node34, 8.0);
+    CPPUNIT_ASSERT_EQUAL( node34->first_child(), point.base_node() );
+    CPPUNIT_ASSERT_EQUAL( 1.0, point.height() );
   }
 
   void testCopyConstructor() {
@@ -844,11 +970,13 @@ class TestForest : public CppUnit::TestCase {
 
   void testPrintLocusSumStats() {
     ostringstream output;
+    OutputBuffer buffer(output);
     forest->writable_model()->addSummaryStatistic(std::make_shared<TMRCA>());
     forest->set_current_base(0);
     forest->set_next_base(forest->model().loci_length());
     forest->calcSegmentSumStats();
-    forest->printLocusSumStats(output);
+    forest->printLocusSumStats(buffer);
+    buffer.flush();
     CPPUNIT_ASSERT( output.str() != "" );
   }
 
@@ -10,6 +10,8 @@
 #include "../../src/model.h"
 #include "../../src/forest.h"
 #include "../../src/summary_statistics/tmrca.h"
+#include "../../src/summary_statistics/seg_sites.h"
+#include "../../src/summary_statistics/frequency_spectrum.h"
 
 class TestModel : public CppUnit::TestCase {
 
@@ -34,6 +36,7 @@ class TestModel : public CppUnit::TestCase {
   CPPUNIT_TEST( testCheck );
   CPPUNIT_TEST( testPopSizeAfterGrowth );
   CPPUNIT_TEST( testAddSummaryStatistic );
+  CPPUNIT_TEST( testCloneSummaryStatistics );
   CPPUNIT_TEST( testSetLocusLength );
   CPPUNIT_TEST( testAddPopToVectorList );
   CPPUNIT_TEST( testAddPopToMatrixList );
@@ -608,6 +611,25 @@ class TestModel : public CppUnit::TestCase {
     CPPUNIT_ASSERT(model.countSummaryStatistics() == 1);
   }
 
+  void testCloneSummaryStatistics() {
+    Model model = Model(5);
+    auto seg_sites = std::make_shared<SegSites>();
+    model.addSummaryStatistic(seg_sites);
+    model.addSummaryStatistic(std::make_shared<FrequencySpectrum>(seg_sites, model));
+
+    Model copy = model;
+    copy.cloneSummaryStatistics();
+    CPPUNIT_ASSERT_EQUAL((size_t)2, copy.countSummaryStatistics());
+    CPPUNIT_ASSERT(copy.getSummaryStatistic(0) != model.getSummaryStatistic(0));
+    CPPUNIT_ASSERT(copy.getSummaryStatistic(1) != model.getSummaryStatistic(1));
+
+    // The copied SFS must use the copied SegSites
+    FrequencySpectrum* sfs = dynamic_cast<FrequencySpectrum*>(copy.getSummaryStatistic(1));
+    CPPUNIT_ASSERT(sfs != NULL);
+    CPPUNIT_ASSERT(sfs->seg_sites().get() == copy.getSummaryStatistic(0));
+    CPPUNIT_ASSERT_EQUAL((size_t)4, sfs->sfs().size());
+  }
+
   void testSetLocusLength() {
     Model model = Model(5);
     model.setLocusLength(10);
@@ -18,6 +18,7 @@ class TestNode : public CppUnit::TestCase {
   CPPUNIT_TEST( testLengthBelow );
   CPPUNIT_TEST( testCountChildren );
   CPPUNIT_TEST( testLocalNavigation );
+  CPPUNIT_TEST( testCompactFields );
 
   CPPUNIT_TEST_SUITE_END();
 
@@ -41,7 +42,8 @@ class TestNode : public CppUnit::TestCase {
   }
 
   void testGettersAndSetters() {
-    Node node1, node2;
+    Node &node1 = *forest->nodes()->createNode(-1),
+         &node2 = *forest->nodes()->createNode(-1);
 
     //height
     node1.set_height(1);
@@ -170,6 +172,28 @@ class TestNode : public CppUnit::TestCase {
     CPPUNIT_ASSERT(forest->nodes()->at(1)->getLocalChild1() == NULL);
     CPPUNIT_ASSERT(n4->getLocalParent() == root);
   }
+
+  void testCompactFields() {
+    const size_t max = std::numeric_limits<NodeCount>::max();
+    Node* node = forest->nodes()->createNode(1, max);
+    CPPUNIT_ASSERT_EQUAL( max, node->label() );
+    node->set_population(max);
+    CPPUNIT_ASSERT_EQUAL( max, node->population() );
+    node->make_nonlocal(max);
+    CPPUNIT_ASSERT_EQUAL( max, node->last_update() );
+    node->set_last_change(max);
+    CPPUNIT_ASSERT_EQUAL( max, node->last_change() );
+    node->set_samples_below(max);
+    CPPUNIT_ASSERT_EQUAL( max, node->samples_below() );
+
+#if defined(SCRM_COMPACT_NODES) && defined(SCRM_NODE_HANDLES)
+#ifdef SCRM_BRANCH_INDEX
+    CPPUNIT_ASSERT_EQUAL( (size_t)104, sizeof(Node) );
+#else
+    CPPUNIT_ASSERT_EQUAL( (size_t)64, sizeof(Node) );
+#endif
+#endif
+  }
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION( TestNode );
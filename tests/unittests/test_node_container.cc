@@ -6,6 +6,8 @@
 #include <cppunit/extensions/HelperMacros.h>
 
 #include "../../src/forest.h"
+#include "../../src/random/constant_generator.h"
+#include "../../src/random/mersenne_twister.h"
 
 
 class TestNodeContainer : public CppUnit::TestCase {
@@ -22,6 +24,13 @@ class TestNodeContainer : public CppUnit::TestCase {
   CPPUNIT_TEST( testCopyConstructor );
   CPPUNIT_TEST( testClear );
   CPPUNIT_TEST( testMemoryAllocation );
+  CPPUNIT_TEST( testLinksAcrossLanes );
+  CPPUNIT_TEST( testSlots );
+#ifdef SCRM_BRANCH_INDEX
+  CPPUNIT_TEST( testFindBranchesCrossing );
+  CPPUNIT_TEST( testIndexedAddAndMove );
+  CPPUNIT_TEST( testOrderIndex );
+#endif
 
   CPPUNIT_TEST_SUITE_END();
 
@@ -234,13 +243,191 @@ class TestNodeContainer : public CppUnit::TestCase {
 
   void testMemoryAllocation() {
     nc.clear();
+    std::vector<Node*> nodes;
     for (size_t i = 0; i < 20005; ++i) {
-      nc.createNode(5);
+      nodes.push_back(nc.createNode(5));
     }
+    nc.add(nodes[0]);
+    nc.remove(nodes[0]);
+    CPPUNIT_ASSERT_EQUAL( (size_t)1, nc.free_slots_.size() );
     nc.clear();
+    CPPUNIT_ASSERT( nc.free_slots_.empty() );
+
+    // After clearing, the slots are reused in the same order
+    size_t lanes = nc.node_lanes_.size();
     for (size_t i = 0; i < 20005; ++i) {
-      nc.createNode(10);
+      Node* node = nc.createNode(10, i);
+      CPPUNIT_ASSERT( node == nodes[i] );
+      CPPUNIT_ASSERT_EQUAL( 10.0, node->height() );
+      CPPUNIT_ASSERT_EQUAL( i, node->label() );
+      CPPUNIT_ASSERT( node->is_root() );
+    }
+    CPPUNIT_ASSERT_EQUAL( lanes, nc.node_lanes_.size() );
+  }
+
+#ifdef SCRM_BRANCH_INDEX
+  // Compares the branch index with searching all nodes below `node`
+  void checkBranchesCrossing(const NodeContainer &nodes, Node const* node, const size_t pop) {
+    std::vector<Node*> expected, found;
+    for (auto it = nodes.iterator(); *it != node; ++it) {
+      if ((*it)->population() == pop && (*it)->parent_height() > node->height()) {
+        expected.push_back(const_cast<Node*>(*it));
+      }
+    }
+    nodes.findBranchesCrossing(node, node->height(), pop, found);
+    CPPUNIT_ASSERT( expected == found );
+  }
+
+  void checkBranchesCrossing(const NodeContainer &nodes) {
+    for (auto it = nodes.iterator(); it.good(); ++it) {
+      checkBranchesCrossing(nodes, *it, 0);
+      checkBranchesCrossing(nodes, *it, 1);
+    }
+  }
+
+  void testFindBranchesCrossing() {
+    ConstantGenerator rg;
+    Model model(0);
+    Forest forest(&model, &rg);
+    forest.createExampleTree();
+    CPPUNIT_ASSERT( !forest.nodes()->has_branch_index() );
+    forest.nodes()->enableBranchIndex();
+    CPPUNIT_ASSERT( forest.nodes()->has_branch_index() );
+    CPPUNIT_ASSERT( forest.nodes()->checkBranchIndex() );
+    checkBranchesCrossing(*forest.nodes());
+
+    // Each population has its own branches
+    forest.nodes()->set_population(forest.nodes()->at(1), 1);
+    forest.nodes()->set_population(forest.nodes()->at(5), 1);
+    CPPUNIT_ASSERT_EQUAL( (size_t)1, forest.nodes()->at(5)->population() );
+    CPPUNIT_ASSERT( forest.nodes()->checkBranchIndex() );
+    checkBranchesCrossing(*forest.nodes());
+
+    // Changes of the tree need to be reflected in the index
+    Node* node = forest.nodes()->at(4);
+    forest.nodes()->move(node, node->height() + 0.5);
+    node->first_child()->set_parent(node->parent());
+    CPPUNIT_ASSERT( forest.nodes()->checkBranchIndex() );
+    checkBranchesCrossing(*forest.nodes());
+
+    forest.nodes()->remove(forest.nodes()->at(1));
+    CPPUNIT_ASSERT( forest.nodes()->checkBranchIndex() );
+    NodeContainer copy = *forest.nodes();
+    CPPUNIT_ASSERT( copy.has_branch_index() );
+    CPPUNIT_ASSERT( copy.checkBranchIndex() );
+    checkBranchesCrossing(copy);
+
+    forest.nodes()->clear();
+    CPPUNIT_ASSERT( !forest.nodes()->has_branch_index() );
+  }
+
+  void testIndexedAddAndMove() {
+    MersenneTwister rg(7);
+    nc.clear();
+    nc.enableBranchIndex();
+    std::vector<Node*> nodes;
+    for (size_t i = 0; i < 5000; ++i) {
+      // Include nodes of equal height
+      nodes.push_back(nc.createNode(rg.sampleInt(1000)));
+      nodes.back()->set_population(rg.sampleInt(3));
+      nc.add(nodes.back(), i > 0 ? nc.first() : NULL);
+    }
+    CPPUNIT_ASSERT( nc.sorted() );
+    CPPUNIT_ASSERT( nc.checkBranchIndex() );
+
+    for (size_t i = 0; i < 5000; i += 2) nc.remove(nodes[i]);
+    for (size_t i = 1; i < 5000; i += 4) nc.move(nodes[i], rg.sampleInt(1000));
+    for (size_t i = 3; i < 5000; i += 4) nc.set_population(nodes[i], rg.sampleInt(3));
+    CPPUNIT_ASSERT_EQUAL( (size_t)2500, nc.size() );
+    CPPUNIT_ASSERT( nc.sorted() );
+    CPPUNIT_ASSERT( nc.checkBranchIndex() );
+  }
+
+  void testOrderIndex() {
+    MersenneTwister rg(7);
+    nc.clear();
+    const size_t n = NodeContainer::kOrderIndexMinNodes * 3 / 2;
+    std::vector<Node*> nodes;
+    for (size_t i = 0; i < n; ++i) {
+      // Include nodes of equal height
+      nodes.push_back(nc.createNode(rg.sampleInt(1000)));
+      if (i % 3 == 0) nc.add(nodes.back());
+      else if (i % 3 == 1) nc.push_front(nc.createNode(-1.0 * i));
+      else nc.add(nodes.back(), nc.first());
+      CPPUNIT_ASSERT_EQUAL( nc.size() >= NodeContainer::kOrderIndexMinNodes, nc.has_order_index() );
+    }
+    CPPUNIT_ASSERT( nc.sorted() );
+    CPPUNIT_ASSERT( nc.checkBranchIndex() );
+
+    for (size_t i = 0; i < n; i += 3) nc.move(nodes[i], rg.sampleInt(1000));
+    for (size_t i = 2; i < n; i += 6) nc.remove(nodes[i]);
+    CPPUNIT_ASSERT( nc.sorted() );
+    CPPUNIT_ASSERT( nc.checkBranchIndex() );
+
+    // Accessing the nodes by position gives the same nodes as walking
+    // through the list
+    size_t position = 0;
+    for (Node* node = nc.first(); node != NULL; node = node->is_last() ? NULL : node->next()) {
+      CPPUNIT_ASSERT( nc.at(position++) == node );
+    }
+    CPPUNIT_ASSERT_EQUAL( nc.size(), position );
+    CPPUNIT_ASSERT_THROW( nc.at(position), std::out_of_range );
+
+    // The copy builds its own order index
+    NodeContainer copy = nc;
+    CPPUNIT_ASSERT( copy.has_order_index() );
+    CPPUNIT_ASSERT( copy.checkBranchIndex() );
+    CPPUNIT_ASSERT_EQUAL( nc.at(1234)->height(), copy.at(1234)->height() );
+
+    nc.clear();
+    CPPUNIT_ASSERT( !nc.has_order_index() );
+  }
+#endif
+
+  void testLinksAcrossLanes() {
+    nc.clear();
+    Node* first = nc.createNode(1);
+    Node* last = first;
+    for (size_t i = 0; i < 2 * NodeContainer::kLaneSize + 5; ++i) {
+      last = nc.createNode(2 + i);
+    }
+    first->set_parent(last);
+    last->set_first_child(first);
+    nc.add(first);
+    nc.add(last);
+    CPPUNIT_ASSERT( first->parent() == last );
+    CPPUNIT_ASSERT( last->first_child() == first );
+    CPPUNIT_ASSERT( first->next() == last );
+    CPPUNIT_ASSERT( last->previous() == first );
+
+    // Links must point into the new container after copying
+    NodeContainer nc2 = NodeContainer(nc);
+    CPPUNIT_ASSERT( nc2.first()->parent() == nc2.last() );
+    CPPUNIT_ASSERT( nc2.last()->first_child() == nc2.first() );
+    CPPUNIT_ASSERT( nc2.first() != first );
+
+    // Reused slots keep their address
+    nc.remove(first);
+    Node* reused = nc.createNode(0.5);
+    CPPUNIT_ASSERT( reused == first );
+    reused->set_parent(last);
+    CPPUNIT_ASSERT( reused->parent() == last );
+  }
+
+  void testSlots() {
+    nc.clear();
+    std::vector<Node*> nodes;
+    for (size_t i = 0; i < NodeContainer::kLaneSize + 5; ++i) {
+      nodes.push_back(nc.createNode(i));
     }
+    for (size_t i = 0; i < nodes.size(); ++i) {
+      CPPUNIT_ASSERT_EQUAL( i, nc.slot(nodes[i]) );
+      CPPUNIT_ASSERT( nc.slotNode(i) == nodes[i] );
+    }
+
+    // Nodes of other containers have no slot here
+    NodeContainer nc2;
+    CPPUNIT_ASSERT_THROW( nc.slot(nc2.createNode(1)), std::out_of_range );
   }
 };
 
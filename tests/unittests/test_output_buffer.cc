@@ -0,0 +1,103 @@
+#include <cppunit/TestCase.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include <sstream>
+#include <limits>
+#include <cstdio>
+#include <cmath>
+#include <random>
+
+#include "../../src/output_buffer.h"
+
+class TestOutputBuffer : public CppUnit::TestCase {
+
+  CPPUNIT_TEST_SUITE( TestOutputBuffer );
+
+  CPPUNIT_TEST( testFormatDouble );
+  CPPUNIT_TEST( testFormatDoubleLikeSnprintf );
+  CPPUNIT_TEST( testFormatInteger );
+  CPPUNIT_TEST( testBuffering );
+
+  CPPUNIT_TEST_SUITE_END();
+
+ private:
+  // Formats a value using a std::ostream with the given precision
+  std::string streamed(const double value, const int precision) {
+    std::ostringstream output;
+    output.precision(precision);
+    output << value;
+    return output.str();
+  }
+
+  std::string buffered(const double value, const int precision) {
+    std::string str;
+    OutputBuffer::formatDouble(str, value, precision);
+    return str;
+  }
+
+ public:
+  void testFormatDouble() {
+    const double values[] = { 0.0, -0.0, 1.0, -1.0, 10.0, 0.5, 0.01, 1.0/3, 
+                              123456.0, 1234567.0, 999999.0, 1e15, 1e16, -2.5e-7,
+                              1e-300, 12345678901234567.0, 
+                              std::numeric_limits<double>::infinity() };
+    const int precisions[] = { 0, 1, 3, 6, 10, 15, 17, 30, 100 };
+    for (double value : values) {
+      for (int precision : precisions) {
+        CPPUNIT_ASSERT_EQUAL( streamed(value, precision), buffered(value, precision) );
+      }
+    }
+  }
+
+  void testFormatDoubleLikeSnprintf() {
+    // The fast formatting gives the same bytes as the "%g" format of snprintf
+    std::mt19937_64 rg(5);
+    std::uniform_real_distribution<> unif(-1, 1);
+    std::uniform_int_distribution<> exponent(-320, 308);
+    char number[512];
+    for (size_t i = 0; i < 20000; ++i) {
+      double value = unif(rg) * std::pow(10.0, i % 2 ? exponent(rg) : exponent(rg) / 20);
+      for (int precision : { 0, 1, 2, 6, 9, 15, 17, 30 }) {
+        snprintf(number, sizeof(number), "%.*g", precision, value);
+        CPPUNIT_ASSERT_EQUAL( std::string(number), buffered(value, precision) );
+      }
+    }
+    snprintf(number, sizeof(number), "%.*g", 6, std::nan(""));
+    CPPUNIT_ASSERT_EQUAL( std::string(number), buffered(std::nan(""), 6) );
+  }
+
+  void testFormatInteger() {
+    std::string str;
+    OutputBuffer::formatInteger(str, 0);
+    OutputBuffer::formatInteger(str, 7);
+    OutputBuffer::formatInteger(str, 1234567890);
+    CPPUNIT_ASSERT_EQUAL( std::string("071234567890"), str );
+
+    std::ostringstream output;
+    OutputBuffer buffer(output);
+    buffer << -12 << ' ' << (size_t)18446744073709551615ULL << ' ' << 0;
+    buffer.flush();
+    CPPUNIT_ASSERT_EQUAL( std::string("-12 18446744073709551615 0"), output.str() );
+  }
+
+  void testBuffering() {
+    std::ostringstream output;
+    output.precision(3);
+    OutputBuffer buffer(output, 10);
+    CPPUNIT_ASSERT_EQUAL( 3, buffer.precision() );
+
+    buffer << "abc" << 'd' << std::string("e") << 1.23456;
+    CPPUNIT_ASSERT_EQUAL( std::string(""), output.str() );
+    buffer << std::vector<double>(2, 0.5);
+    CPPUNIT_ASSERT_EQUAL( std::string("abcde1.230.5"), output.str() );
+    buffer.flush();
+    CPPUNIT_ASSERT_EQUAL( std::string("abcde1.230.5 0.5 "), output.str() );
+
+    {
+      OutputBuffer buffer2(output);
+      buffer2 << "\n";
+    }
+    CPPUNIT_ASSERT_EQUAL( std::string("abcde1.230.5 0.5 \n"), output.str() );
+  }
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION( TestOutputBuffer );
@@ -28,7 +28,12 @@ class TestParam : public CppUnit::TestCase {
   CPPUNIT_TEST( testScientificNotation );
   CPPUNIT_TEST( testApproximation );
   CPPUNIT_TEST( testTransposeSegSites );
+  CPPUNIT_TEST( testBinaryOutput );
   CPPUNIT_TEST( testNoMigrationBeforePopSetup );
+  CPPUNIT_TEST( testParseThreads );
+  CPPUNIT_TEST( testParseStreams );
+  CPPUNIT_TEST( testParseRandomGenerator );
+  CPPUNIT_TEST( testParseStats );
 
   CPPUNIT_TEST_SUITE_END();
 
@@ -325,6 +330,29 @@ class TestParam : public CppUnit::TestCase {
 
     CPPUNIT_ASSERT_NO_THROW(model = Param("20 10 -oSFS -t 5 -L -T").parse());
     CPPUNIT_ASSERT( model.summary_statistics_.size() == 4 );
+
+    CPPUNIT_ASSERT_NO_THROW(model = Param("20 10 -r 5 100 -oTS").parse());
+    CPPUNIT_ASSERT( model.summary_statistics_.size() == 1 );
+    CPPUNIT_ASSERT( dynamic_cast<TreeSequence*>(model.getSummaryStatistic(0)) != NULL );
+
+    CPPUNIT_ASSERT_NO_THROW(model = Param("20 10 -r 5 100 -oBSFS").parse());
+    CPPUNIT_ASSERT( model.summary_statistics_.size() == 1 );
+    CPPUNIT_ASSERT( dynamic_cast<BranchFrequencySpectrum*>(model.getSummaryStatistic(0)) != NULL );
+
+    CPPUNIT_ASSERT_THROW(Param("20 10 -oPi").parse(), std::invalid_argument );
+    CPPUNIT_ASSERT_NO_THROW(model = Param("20 10 -t 5 -oPi -oThetaW -oTajD -oNSFS").parse());
+    CPPUNIT_ASSERT( model.summary_statistics_.size() == 5 );
+    CPPUNIT_ASSERT( dynamic_cast<TajimasD*>(model.getSummaryStatistic(3)) != NULL );
+
+    Param param("20 10 -t 5 -oRow");
+    CPPUNIT_ASSERT_NO_THROW(model = param.parse());
+    CPPUNIT_ASSERT( param.compact_output() );
+    CPPUNIT_ASSERT( model.summary_statistics_.size() == 1 );
+    StatisticsTable* table = dynamic_cast<StatisticsTable*>(model.getSummaryStatistic(0));
+    CPPUNIT_ASSERT( table != NULL && table->names().size() == 4 );
+    CPPUNIT_ASSERT_THROW(Param("20 10 -oRow").parse(), std::invalid_argument );
+    CPPUNIT_ASSERT_THROW(Param("20 10 -t 5 -oRow -T").parse(), std::invalid_argument );
+    CPPUNIT_ASSERT_THROW(Param("20 10 -t 5 -oMeans -threads 2").parse(), std::invalid_argument );
   }
 
   void testParseGrowthOptions() {
@@ -525,6 +553,21 @@ class TestParam : public CppUnit::TestCase {
     CPPUNIT_ASSERT(!ss->get_transpose());
   }
 
+  void testBinaryOutput() {
+    Model model = Param("2 2 -r 10 100 -t 5 -o bin").parse();
+    SegSites* ss = dynamic_cast<SegSites*>(model.getSummaryStatistic(0));
+    CPPUNIT_ASSERT(ss->binary());
+
+    model = Param("2 2 -t 5 -o ms").parse();
+    ss = dynamic_cast<SegSites*>(model.getSummaryStatistic(0));
+    CPPUNIT_ASSERT(!ss->binary());
+
+    CPPUNIT_ASSERT_THROW(Param("2 2 -o bin").parse(), std::invalid_argument);
+    CPPUNIT_ASSERT_THROW(Param("2 2 -t 5 -o").parse(), std::invalid_argument);
+    CPPUNIT_ASSERT_THROW(Param("2 2 -t 5 -o txt").parse(), std::invalid_argument);
+    CPPUNIT_ASSERT_THROW(Param("2 2 -t 5 -o bin -transpose-segsites").parse(), std::invalid_argument);
+  }
+
   void testNoMigrationBeforePopSetup() {
     CPPUNIT_ASSERT_THROW(Param("2 2 -M 3 -I 2 1 1 1 -t 5").parse(), std::invalid_argument);
     CPPUNIT_ASSERT_THROW(Param("2 2 -m 1 2 3 -I 2 1 1 1 -t 5").parse(), std::invalid_argument);
@@ -532,6 +575,74 @@ class TestParam : public CppUnit::TestCase {
     CPPUNIT_ASSERT_NO_THROW(Param("2 2 -g 1 3 -I 2 1 1 1 -t 5").parse());
     CPPUNIT_ASSERT_NO_THROW(Param("6 3 -r 20 200 -I 3 2 2 2 1.0").parse());
   }
+
+  void testParseThreads() {
+    Param pars = Param("4 7 -t 5");
+    CPPUNIT_ASSERT_NO_THROW(pars.parse());
+    CPPUNIT_ASSERT_EQUAL((size_t)0, pars.threads());
+
+    pars = Param("4 7 -t 5 -threads 4");
+    CPPUNIT_ASSERT_NO_THROW(pars.parse());
+    CPPUNIT_ASSERT_EQUAL((size_t)4, pars.threads());
+
+    CPPUNIT_ASSERT_THROW(Param("4 7 -t 5 -threads 0").parse(), std::invalid_argument);
+    CPPUNIT_ASSERT_THROW(Param("4 7 -t 5 -threads").parse(), std::invalid_argument);
+    CPPUNIT_ASSERT( pars.streams() );
+  }
+
+  void testParseStreams() {
+    Param pars = Param("4 7 -t 5");
+    CPPUNIT_ASSERT_NO_THROW(pars.parse());
+    CPPUNIT_ASSERT( !pars.streams() );
+    CPPUNIT_ASSERT_EQUAL((size_t)0, pars.first_locus());
+
+    pars = Param("4 7 -t 5 -streams");
+    CPPUNIT_ASSERT_NO_THROW(pars.parse());
+    CPPUNIT_ASSERT( pars.streams() );
+    CPPUNIT_ASSERT_EQUAL((size_t)0, pars.first_locus());
+
+    pars = Param("4 1 -t 5 -first-locus 12");
+    CPPUNIT_ASSERT_NO_THROW(pars.parse());
+    CPPUNIT_ASSERT( pars.streams() );
+    CPPUNIT_ASSERT_EQUAL((size_t)11, pars.first_locus());
+
+    CPPUNIT_ASSERT_THROW(Param("4 1 -t 5 -first-locus 0").parse(), std::invalid_argument);
+  }
+
+  void testParseStats() {
+    Param pars = Param("4 7 -t 5");
+    CPPUNIT_ASSERT_NO_THROW(pars.parse());
+    CPPUNIT_ASSERT( !pars.print_stats() );
+
+#ifdef SCRM_STATS
+    pars = Param("4 7 -t 5 -stats");
+    CPPUNIT_ASSERT_NO_THROW(pars.parse());
+    CPPUNIT_ASSERT( pars.print_stats() );
+#else
+    CPPUNIT_ASSERT_THROW(Param("4 7 -t 5 -stats").parse(), std::invalid_argument);
+#endif
+  }
+
+  void testParseRandomGenerator() {
+    Param pars = Param("4 7 -t 5");
+    CPPUNIT_ASSERT_NO_THROW(pars.parse());
+    CPPUNIT_ASSERT( pars.random_generator() == mersenne_twister );
+
+    pars = Param("4 7 -t 5 -rng xoshiro");
+    CPPUNIT_ASSERT_NO_THROW(pars.parse());
+    CPPUNIT_ASSERT( pars.random_generator() == xoshiro256 );
+
+    pars = Param("4 7 -t 5 -rng philox");
+    CPPUNIT_ASSERT_NO_THROW(pars.parse());
+    CPPUNIT_ASSERT( pars.random_generator() == philox4x32 );
+
+    pars = Param("4 7 -t 5 -rng mt");
+    CPPUNIT_ASSERT_NO_THROW(pars.parse());
+    CPPUNIT_ASSERT( pars.random_generator() == mersenne_twister );
+
+    CPPUNIT_ASSERT_THROW(Param("4 7 -t 5 -rng ranlux").parse(), std::invalid_argument);
+    CPPUNIT_ASSERT_THROW(Param("4 7 -t 5 -rng").parse(), std::invalid_argument);
+  }
 };
 
 //Uncomment this to activate the test
@@ -3,8 +3,11 @@
  */
 #include <cppunit/TestCase.h>
 #include <cppunit/extensions/HelperMacros.h>
+#include <memory>
 #include "../../src/random/mersenne_twister.h"
 #include "../../src/random/random_generator.h"
+#include "../../src/random/xoshiro256.h"
+#include "../../src/random/philox.h"
 
 class TestRandomGenerator : public CppUnit::TestCase {
 
@@ -17,15 +20,20 @@ class TestRandomGenerator : public CppUnit::TestCase {
   CPPUNIT_TEST( testSampleExpoExpoLimit );
   CPPUNIT_TEST( testSampleInt );
   CPPUNIT_TEST( testSeeding );
+  CPPUNIT_TEST( testStreams );
+  CPPUNIT_TEST( testBufferedSampling );
 
   CPPUNIT_TEST_SUITE_END();
 
- private:
+ protected:
   RandomGenerator *rg;
 
+  // The type of the generator that is tested
+  virtual GeneratorType type() const { return mersenne_twister; }
+
  public:
   void setUp() {
-    rg = new MersenneTwister(5);
+    rg = RandomGenerator::create(type(), 5);
   }
 
   void tearDown() {
@@ -47,7 +55,7 @@ class TestRandomGenerator : public CppUnit::TestCase {
   }
 
   void testSampleUnitExpo() {
-    size_t n = 10000;
+    size_t n = 1000000;
     double expo = 0.0;
     for (size_t i = 0; i < n; ++i) {
       expo += rg->sampleUnitExponential();
@@ -57,7 +65,7 @@ class TestRandomGenerator : public CppUnit::TestCase {
   }
 
   void testSampleExpo() {
-    size_t n = 100000;
+    size_t n = 1000000;
     double expo = 0;
     for (size_t i = 0; i < n; ++i) {
       expo += rg->sampleExpo(5);
@@ -133,9 +141,137 @@ class TestRandomGenerator : public CppUnit::TestCase {
     rg->set_seed(5);
     CPPUNIT_ASSERT_EQUAL( sample, rg->sampleInt(10000) );
 
-    MersenneTwister rg2 = MersenneTwister(5);
-    CPPUNIT_ASSERT_EQUAL( sample, rg2.sampleInt(10000) );
+    std::unique_ptr<RandomGenerator> rg2(RandomGenerator::create(type(), 5));
+    CPPUNIT_ASSERT_EQUAL( sample, rg2->sampleInt(10000) );
+  }
+
+  void testStreams() {
+    rg->set_stream(7);
+    double sample = rg->sample();
+    double expo = rg->sampleExpo(1.0);
+
+    // Streams do not depend on previous draws
+    for (size_t i = 0; i < 100; ++i) rg->sample();
+    rg->set_stream(7);
+    CPPUNIT_ASSERT_EQUAL( sample, rg->sample() );
+    CPPUNIT_ASSERT_EQUAL( expo, rg->sampleExpo(1.0) );
+
+    std::unique_ptr<RandomGenerator> rg2(RandomGenerator::create(type(), 5));
+    rg2->set_stream(7);
+    CPPUNIT_ASSERT_EQUAL( sample, rg2->sample() );
+
+    // But on the seed and the stream number
+    rg2->set_stream(8);
+    CPPUNIT_ASSERT( sample != rg2->sample() );
+    rg2->set_seed(6);
+    rg2->set_stream(7);
+    CPPUNIT_ASSERT( sample != rg2->sample() );
+  }
+
+  void testBufferedSampling() {
+    // The numbers of the Mersenne Twister equal those of the standard distribution
+    if (type() == mersenne_twister) {
+      std::mt19937_64 mt(5);
+      std::uniform_real_distribution<> unif(0, 1);
+      rg->set_seed(5);
+      unif(mt); // Used for the cached unit exponential
+      for (size_t i = 0; i < 5000; ++i) {
+        CPPUNIT_ASSERT_EQUAL( unif(mt), rg->sample() );
+      }
+
+      // Also for streams, which seed both with the same sequence
+      std::seed_seq seed_sequence{ 5, 0, 3, 0 };
+      mt.seed(seed_sequence);
+      rg->set_stream(3);
+      unif(mt);
+      for (size_t i = 0; i < 1000; ++i) {
+        CPPUNIT_ASSERT_EQUAL( unif(mt), rg->sample() );
+      }
+    }
+
+    // Sampling a block gives the same numbers as sampling one by one
+    double block[600];
+    rg->set_seed(5);
+    rg->sample();
+    rg->sample(block, 600);
+    rg->set_seed(5);
+    rg->sample();
+    for (size_t i = 0; i < 600; ++i) {
+      CPPUNIT_ASSERT_EQUAL( rg->sample(), block[i] );
+    }
+
+    // Reseeding drops the buffered numbers
+    rg->set_seed(6);
+    double sample = rg->sample();
+    rg->set_seed(5);
+    rg->set_seed(6);
+    CPPUNIT_ASSERT_EQUAL( sample, rg->sample() );
   }
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION( TestRandomGenerator );
+
+
+class TestXoshiro256 : public TestRandomGenerator {
+
+  CPPUNIT_TEST_SUB_SUITE( TestXoshiro256, TestRandomGenerator );
+  CPPUNIT_TEST( testReferenceOutput );
+  CPPUNIT_TEST_SUITE_END();
+
+ protected:
+  GeneratorType type() const { return xoshiro256; }
+
+ public:
+  void testReferenceOutput() {
+    // Outputs of the reference implementation for the state 1, 2, 3, 4
+    Xoshiro256 xoshiro(5);
+    for (size_t i = 0; i < 4; ++i) xoshiro.state_[i] = i + 1;
+    CPPUNIT_ASSERT_EQUAL( (uint64_t)11520, xoshiro.next() );
+    CPPUNIT_ASSERT_EQUAL( (uint64_t)0, xoshiro.next() );
+    CPPUNIT_ASSERT_EQUAL( (uint64_t)1509978240, xoshiro.next() );
+    CPPUNIT_ASSERT_EQUAL( (uint64_t)1215971899390074240, xoshiro.next() );
+  }
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION( TestXoshiro256 );
+
+
+class TestPhilox : public TestRandomGenerator {
+
+  CPPUNIT_TEST_SUB_SUITE( TestPhilox, TestRandomGenerator );
+  CPPUNIT_TEST( testReferenceOutput );
+  CPPUNIT_TEST_SUITE_END();
+
+ protected:
+  GeneratorType type() const { return philox4x32; }
+
+ public:
+  void testReferenceOutput() {
+    // Known answers of the Random123 library
+    uint32_t result[4];
+    const uint32_t counter0[4] = { 0, 0, 0, 0 }, key0[2] = { 0, 0 };
+    Philox::encrypt(counter0, key0, result);
+    CPPUNIT_ASSERT_EQUAL( (uint32_t)0x6627e8d5, result[0] );
+    CPPUNIT_ASSERT_EQUAL( (uint32_t)0xe169c58d, result[1] );
+    CPPUNIT_ASSERT_EQUAL( (uint32_t)0xbc57ac4c, result[2] );
+    CPPUNIT_ASSERT_EQUAL( (uint32_t)0x9b00dbd8, result[3] );
+
+    const uint32_t counter1[4] = { 0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff },
+                   key1[2] = { 0xffffffff, 0xffffffff };
+    Philox::encrypt(counter1, key1, result);
+    CPPUNIT_ASSERT_EQUAL( (uint32_t)0x408f276d, result[0] );
+    CPPUNIT_ASSERT_EQUAL( (uint32_t)0x41c83b0e, result[1] );
+    CPPUNIT_ASSERT_EQUAL( (uint32_t)0xa20bc7c6, result[2] );
+    CPPUNIT_ASSERT_EQUAL( (uint32_t)0x6d5451fd, result[3] );
+
+    const uint32_t counter2[4] = { 0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344 },
+                   key2[2] = { 0xa4093822, 0x299f31d0 };
+    Philox::encrypt(counter2, key2, result);
+    CPPUNIT_ASSERT_EQUAL( (uint32_t)0xd16cfe09, result[0] );
+    CPPUNIT_ASSERT_EQUAL( (uint32_t)0x94fdcceb, result[1] );
+    CPPUNIT_ASSERT_EQUAL( (uint32_t)0x5001e420, result[2] );
+    CPPUNIT_ASSERT_EQUAL( (uint32_t)0x24126ea1, result[3] );
+  }
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION( TestPhilox );
@@ -0,0 +1,125 @@
+#include <cppunit/TestCase.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include <vector>
+
+#include "../../src/simulator.h"
+#include "../../src/param.h"
+#include "../../src/random/mersenne_twister.h"
+
+class TestSimulator : public CppUnit::TestCase {
+
+  CPPUNIT_TEST_SUITE( TestSimulator );
+
+  CPPUNIT_TEST( testSegmentsAndTrees );
+  CPPUNIT_TEST( testMutations );
+  CPPUNIT_TEST( testLoci );
+
+  CPPUNIT_TEST_SUITE_END();
+
+ public:
+  void testSegmentsAndTrees() {
+    Model model = Param("6 2 -r 5 1000 -l -1").parse();
+    Simulator simulator(model, 5);
+
+    std::vector<double> segments;
+    size_t trees = 0;
+    simulator.set_segment_callback([&](const Simulator::Segment &segment) {
+      CPPUNIT_ASSERT( segment.start < segment.end );
+      CPPUNIT_ASSERT_EQUAL( segment.start, segment.forest->current_base() );
+      if (segment.start == 0.0) segments.push_back(0.0);
+      segments.back() += segment.end - segment.start;
+    });
+    simulator.set_tree_callback([&](const Simulator::Tree &tree) {
+      ++trees;
+      CPPUNIT_ASSERT_EQUAL( (size_t)11, tree.parents->size() );
+      CPPUNIT_ASSERT_EQUAL( -1, tree.parents->at(10) );
+      for (size_t i = 0; i < 10; ++i) {
+        int parent = tree.parents->at(i);
+        CPPUNIT_ASSERT( (int)i < parent && parent <= 10 );
+        CPPUNIT_ASSERT( tree.heights->at(i) < tree.heights->at(parent) );
+        if (i < 6) CPPUNIT_ASSERT_EQUAL( 0.0, tree.heights->at(i) );
+      }
+    });
+    simulator.simulate();
+
+    // The segments cover both loci, and each has a tree
+    CPPUNIT_ASSERT_EQUAL( (size_t)2, segments.size() );
+    CPPUNIT_ASSERT_EQUAL( 1000.0, segments[0] );
+    CPPUNIT_ASSERT_EQUAL( 1000.0, segments[1] );
+    CPPUNIT_ASSERT( trees > 2 );
+  }
+
+  void testMutations() {
+    // With streams, the mutations are the same as in scrm
+    Model model = Param("5 3 -t 5 -r 2 100 -streams").parse();
+    Simulator simulator(model, 7);
+    simulator.set_streams(true);
+
+    std::vector<double> positions;
+    simulator.set_mutation_callback([&](const Simulator::Mutation &mutation) {
+      positions.push_back(mutation.position);
+      CPPUNIT_ASSERT( mutation.haplotype != NULL );
+      CPPUNIT_ASSERT_EQUAL( (size_t)1, mutation.words );
+      size_t derived = 0;
+      for (size_t i = 0; i < 5; ++i) derived += (mutation.haplotype[0] >> i) & 1;
+      CPPUNIT_ASSERT_EQUAL( mutation.derived, derived );
+    });
+    simulator.simulate();
+    CPPUNIT_ASSERT( positions.size() > 0 );
+
+    MersenneTwister rg(7);
+    Forest forest(&model, &rg);
+    SegSites* seg_sites = dynamic_cast<SegSites*>(model.getSummaryStatistic(0));
+    CPPUNIT_ASSERT( seg_sites != NULL );
+    std::vector<double> expected;
+    for (size_t locus = 0; locus < 3; ++locus) {
+      rg.set_stream(locus);
+      forest.buildInitialTree();
+      while (forest.next_base() < model.loci_length()) forest.sampleNextGenealogy();
+      expected.insert(expected.end(), seg_sites->positions()->begin(), seg_sites->positions()->end());
+      forest.clear();
+    }
+    CPPUNIT_ASSERT( expected == positions );
+
+    // A SegSites object is added if the model has none
+    Model model2 = Param("5 1 -r 2 100").parse();
+    model2.setMutationRate(5, true, true);
+    Simulator simulator2(model2, 7);
+    size_t mutations = 0;
+    simulator2.set_mutation_callback([&](const Simulator::Mutation &) { ++mutations; });
+    simulator2.simulate();
+    CPPUNIT_ASSERT( mutations > 0 );
+    CPPUNIT_ASSERT_EQUAL( (size_t)0, model2.countSummaryStatistics() );
+  }
+
+  void testLoci() {
+    Model model = Param("4 3 -r 1 100").parse();
+    Simulator simulator(model, 7);
+
+    std::vector<size_t> loci;
+    simulator.set_locus_callback([&](size_t locus) { loci.push_back(locus); });
+    simulator.simulate();
+    simulator.simulate(2);
+    CPPUNIT_ASSERT_EQUAL( (size_t)5, loci.size() );
+    for (size_t i = 0; i < 5; ++i) CPPUNIT_ASSERT_EQUAL( i, loci[i] );
+    CPPUNIT_ASSERT_EQUAL( (size_t)5, simulator.next_locus() );
+
+    // The mutations of each locus lie on the local trees of that locus
+    Model model2 = Param("5 4 -t 5 -r 2 100").parse();
+    Simulator simulator2(model2, 7);
+    double tmrca = 0.0;
+    std::vector<size_t> mutations(4, 0);
+    simulator2.set_tree_callback([&](const Simulator::Tree &tree) {
+      tmrca = tree.heights->back();
+    });
+    simulator2.set_mutation_callback([&](const Simulator::Mutation &mutation) {
+      ++mutations[mutation.locus];
+      CPPUNIT_ASSERT( 0.0 <= mutation.height );
+      CPPUNIT_ASSERT( mutation.height < tmrca );
+    });
+    simulator2.simulate();
+    for (size_t locus = 0; locus < 4; ++locus) CPPUNIT_ASSERT( mutations[locus] > 0 );
+  }
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION( TestSimulator );
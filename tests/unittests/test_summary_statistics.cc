@@ -3,8 +3,8 @@
  */
 #include <cppunit/TestCase.h>
 #include <cppunit/extensions/HelperMacros.h>
-#include <valarray>
 #include <memory>
+#include <cstring>
 
 #include "../../src/forest.h"
 #include "../../src/tree_point.h"
@@ -15,6 +15,11 @@
 #include "../../src/summary_statistics/frequency_spectrum.h"
 #include "../../src/summary_statistics/oriented_forest.h"
 #include "../../src/summary_statistics/newick_tree.h"
+#include "../../src/summary_statistics/tree_sequence.h"
+#include "../../src/summary_statistics/sfs_statistics.h"
+#include "../../src/summary_statistics/statistics_table.h"
+#include "../../src/summary_statistics/branch_frequency_spectrum.h"
+#include "../../src/param.h"
 
 class TestSummaryStatistics : public CppUnit::TestCase {
 
@@ -22,12 +27,20 @@ class TestSummaryStatistics : public CppUnit::TestCase {
 
   CPPUNIT_TEST( testTMRCA );
   CPPUNIT_TEST( testSegSitesTraversal );
-  CPPUNIT_TEST( testSegSitesGetHaplotypes );
+  CPPUNIT_TEST( testSegSitesAddHaplotype );
   CPPUNIT_TEST( testSegSitesCalculate );
+  CPPUNIT_TEST( testSegSitesPlaceMutations );
+  CPPUNIT_TEST( testSegSitesBinaryOutput );
   CPPUNIT_TEST( testSiteFrequencies );
   CPPUNIT_TEST( testOrientedForestGenerateTreeData );
   CPPUNIT_TEST( testOrientedForest );
+  CPPUNIT_TEST( testOrientedForestIncremental );
   CPPUNIT_TEST( testNewickTree );
+  CPPUNIT_TEST( testTreeSequence );
+  CPPUNIT_TEST( testTreeSequenceWithRecombination );
+  CPPUNIT_TEST( testBranchFrequencySpectrum );
+  CPPUNIT_TEST( testSfsStatistics );
+  CPPUNIT_TEST( testStatisticsTable );
 
   CPPUNIT_TEST_SUITE_END();
 
@@ -68,68 +81,68 @@ class TestSummaryStatistics : public CppUnit::TestCase {
   void testSegSitesTraversal() {
     SegSites seg_sites = SegSites();
 
-    std::valarray <bool>haplotype(4);
-    seg_sites.traversal(forest->nodes()->at(4), haplotype);
-    CPPUNIT_ASSERT_EQUAL( true,  haplotype[0] );
-    CPPUNIT_ASSERT_EQUAL( true,  haplotype[1] );
-    CPPUNIT_ASSERT_EQUAL( false, haplotype[2] );
-    CPPUNIT_ASSERT_EQUAL( false, haplotype[3] );
-
-    haplotype *= 0;
-    seg_sites.traversal(forest->nodes()->at(5), haplotype);
-    CPPUNIT_ASSERT_EQUAL( false, haplotype[0] );
-    CPPUNIT_ASSERT_EQUAL( false, haplotype[1] );
-    CPPUNIT_ASSERT_EQUAL( true,  haplotype[2] );
-    CPPUNIT_ASSERT_EQUAL( true,  haplotype[3] );
-
-    haplotype *= 0;
-    seg_sites.traversal(forest->nodes()->at(8), haplotype);
-    CPPUNIT_ASSERT_EQUAL( true, haplotype[0] );
-    CPPUNIT_ASSERT_EQUAL( true, haplotype[1] );
-    CPPUNIT_ASSERT_EQUAL( true, haplotype[2] );
-    CPPUNIT_ASSERT_EQUAL( true, haplotype[3] );
-
-    haplotype *= 0;
-    seg_sites.traversal(forest->nodes()->at(0), haplotype);
-    CPPUNIT_ASSERT_EQUAL( false, haplotype[0] );
-    CPPUNIT_ASSERT_EQUAL( false, haplotype[1] );
-    CPPUNIT_ASSERT_EQUAL( false, haplotype[2] );
-    CPPUNIT_ASSERT_EQUAL( true,  haplotype[3] );
-
-    haplotype *= 0;
-    seg_sites.traversal(forest->nodes()->at(1), haplotype);
-    CPPUNIT_ASSERT_EQUAL( false, haplotype[0] );
-    CPPUNIT_ASSERT_EQUAL( false, haplotype[1] );
-    CPPUNIT_ASSERT_EQUAL( true,  haplotype[2] );
-    CPPUNIT_ASSERT_EQUAL( false, haplotype[3] );
+    uint64_t haplotype = 0;
+    seg_sites.traversal(forest->nodes()->at(4), &haplotype);
+    CPPUNIT_ASSERT_EQUAL( (uint64_t)3, haplotype );
+
+    haplotype = 0;
+    seg_sites.traversal(forest->nodes()->at(5), &haplotype);
+    CPPUNIT_ASSERT_EQUAL( (uint64_t)12, haplotype );
+
+    haplotype = 0;
+    seg_sites.traversal(forest->nodes()->at(8), &haplotype);
+    CPPUNIT_ASSERT_EQUAL( (uint64_t)15, haplotype );
+
+    haplotype = 0;
+    seg_sites.traversal(forest->nodes()->at(0), &haplotype);
+    CPPUNIT_ASSERT_EQUAL( (uint64_t)8, haplotype );
+
+    haplotype = 0;
+    seg_sites.traversal(forest->nodes()->at(1), &haplotype);
+    CPPUNIT_ASSERT_EQUAL( (uint64_t)4, haplotype );
   }
 
-  void testSegSitesGetHaplotypes() {
+  void testSegSitesAddHaplotype() {
     SegSites seg_sites = SegSites();
+    seg_sites.set_sample_size(4);
+    CPPUNIT_ASSERT_EQUAL( (size_t)1, seg_sites.words_per_site() );
+
+    seg_sites.positions_.push_back(0.1);
+    seg_sites.addHaplotype(TreePoint(forest->nodes()->at(4), 1, true));
+    seg_sites.positions_.push_back(0.2);
+    seg_sites.addHaplotype(TreePoint(forest->nodes()->at(5), 0.5, true));
+    seg_sites.positions_.push_back(0.3);
+    seg_sites.addHaplotype(TreePoint(forest->nodes()->at(8), 0.5, true));
+
+    CPPUNIT_ASSERT_EQUAL( (size_t)3, seg_sites.haplotypes_.size() );
+    CPPUNIT_ASSERT_EQUAL( true, seg_sites.getAllele(0, 0) );
+    CPPUNIT_ASSERT_EQUAL( true, seg_sites.getAllele(0, 1) );
+    CPPUNIT_ASSERT_EQUAL( false, seg_sites.getAllele(0, 2) );
+    CPPUNIT_ASSERT_EQUAL( false, seg_sites.getAllele(0, 3) );
+    CPPUNIT_ASSERT_EQUAL( (uint64_t)12, *seg_sites.getHaplotypeWords(1) );
+    CPPUNIT_ASSERT_EQUAL( (uint64_t)15, *seg_sites.getHaplotypeWords(2) );
+    CPPUNIT_ASSERT_THROW( seg_sites.getHaplotypeWords(3), std::out_of_range );
+
+    // Samples beyond the first word
+    seg_sites.clear();
+    seg_sites.set_sample_size(130);
+    CPPUNIT_ASSERT_EQUAL( (size_t)3, seg_sites.words_per_site() );
+    seg_sites.positions_.push_back(0.1);
+    seg_sites.haplotypes_ = { 1, 0, 2 };
+    CPPUNIT_ASSERT_EQUAL( true, seg_sites.getAllele(0, 0) );
+    CPPUNIT_ASSERT_EQUAL( false, seg_sites.getAllele(0, 64) );
+    CPPUNIT_ASSERT_EQUAL( false, seg_sites.getAllele(0, 128) );
+    CPPUNIT_ASSERT_EQUAL( true, seg_sites.getAllele(0, 129) );
 
-    TreePoint mutation = TreePoint(forest->nodes()->at(4), 1, true);
-    std::valarray<bool> haplotype = seg_sites.getHaplotypes(mutation, *forest);
-    CPPUNIT_ASSERT_EQUAL( (size_t)4, haplotype.size() );
-    CPPUNIT_ASSERT_EQUAL( true, haplotype[0] );
-    CPPUNIT_ASSERT_EQUAL( true, haplotype[1] );
-    CPPUNIT_ASSERT_EQUAL( false, haplotype[2] );
-    CPPUNIT_ASSERT_EQUAL( false, haplotype[3] );
-
-    mutation = TreePoint(forest->nodes()->at(5), 0.5, true);
-    haplotype = seg_sites.getHaplotypes(mutation, *forest);
-    CPPUNIT_ASSERT_EQUAL( (size_t)4, haplotype.size() );
-    CPPUNIT_ASSERT_EQUAL( false, haplotype[0] );
-    CPPUNIT_ASSERT_EQUAL( false, haplotype[1] );
-    CPPUNIT_ASSERT_EQUAL( true, haplotype[2] );
-    CPPUNIT_ASSERT_EQUAL( true, haplotype[3] );
-
-    mutation = TreePoint(forest->nodes()->at(8), 0.5, true);
-    haplotype = seg_sites.getHaplotypes(mutation, *forest);
-    CPPUNIT_ASSERT_EQUAL( (size_t)4, haplotype.size() );
-    CPPUNIT_ASSERT_EQUAL( true, haplotype[0] );
-    CPPUNIT_ASSERT_EQUAL( true, haplotype[1] );
-    CPPUNIT_ASSERT_EQUAL( true, haplotype[2] );
-    CPPUNIT_ASSERT_EQUAL( true, haplotype[3] );
+    std::ostringstream output;
+    OutputBuffer buffer(output);
+    seg_sites.printLocusOutput(buffer);
+    buffer.flush();
+    std::string haplotypes = output.str();
+    haplotypes = haplotypes.substr(haplotypes.find("\n", haplotypes.find("positions")) + 1);
+    CPPUNIT_ASSERT_EQUAL( (size_t)260, haplotypes.size() );
+    CPPUNIT_ASSERT_EQUAL( std::string("1\n0\n"), haplotypes.substr(0, 4) );
+    CPPUNIT_ASSERT_EQUAL( std::string("0\n1\n"), haplotypes.substr(256, 4) );
   }
 
   void testSegSitesCalculate() {
@@ -145,19 +158,16 @@ class TestSummaryStatistics : public CppUnit::TestCase {
     seg_sites.positions_.push_back(0.7);
     seg_sites.positions_.push_back(0.8);
 
-    std::valarray<bool> ht = {1, 0, 0, 0};
-    seg_sites.haplotypes_.push_back(ht);
-    ht[1] = 1;
-    seg_sites.haplotypes_.push_back(ht);
-    ht = 0;
-    ht[1] = 1;
-    seg_sites.haplotypes_.push_back(ht);
+    seg_sites.set_sample_size(4);
+    seg_sites.haplotypes_.push_back(1); // 1000
+    seg_sites.haplotypes_.push_back(3); // 1100
+    seg_sites.haplotypes_.push_back(2); // 0100
 
     // Check status
     CPPUNIT_ASSERT_EQUAL( (size_t)3, seg_sites.countMutations() );
-    CPPUNIT_ASSERT_EQUAL( (size_t)4, seg_sites.getHaplotype(0)->size() );
-    CPPUNIT_ASSERT_EQUAL( (size_t)4, seg_sites.getHaplotype(1)->size() );
-    CPPUNIT_ASSERT_EQUAL( (size_t)4, seg_sites.getHaplotype(2)->size() );
+    CPPUNIT_ASSERT_EQUAL( (size_t)4, seg_sites.sample_size() );
+    CPPUNIT_ASSERT_EQUAL( true, seg_sites.getAllele(1, 1) );
+    CPPUNIT_ASSERT_EQUAL( false, seg_sites.getAllele(2, 0) );
 
     // Check clear
     seg_sites.clear();
@@ -169,10 +179,10 @@ class TestSummaryStatistics : public CppUnit::TestCase {
     int freqs[4] = { 0 };
     int types[2] = { 0 };
     int sum = 0;
-    for (auto it = seg_sites.haplotypes_.begin(); it != seg_sites.haplotypes_.end(); ++it) {
+    for (size_t j = 0; j < seg_sites.countMutations(); ++j) {
       for (size_t i = 0; i < 4; ++i) {
-        if ((*it)[i]) ++freqs[i];
-        sum += (*it)[i];
+        if (seg_sites.getAllele(j, i)) ++freqs[i];
+        sum += seg_sites.getAllele(j, i);
       }
       CPPUNIT_ASSERT( sum == 1 || sum == 2 );
       ++types[sum-1];
@@ -196,6 +206,71 @@ class TestSummaryStatistics : public CppUnit::TestCase {
     CPPUNIT_ASSERT_EQUAL( mutation_count, seg_sites.countMutations() );
   }
 
+  void testSegSitesPlaceMutations() {
+    forest->createScaledExampleTree();
+    forest->writable_model()->setMutationRate(0.0001);
+    forest->set_current_base(0.0);
+    forest->set_next_base(15.0);
+    SegSites seg_sites = SegSites();
+    seg_sites.calculate(*forest);
+
+    // Enough mutations to place them as a batch
+    CPPUNIT_ASSERT( seg_sites.countMutations() * 8 >= 4 );
+    CPPUNIT_ASSERT_EQUAL( (size_t)6, seg_sites.branches_.size() );
+
+    // Each mutation must fall on a branch of the example tree
+    for (size_t j = 0; j < seg_sites.countMutations(); ++j) {
+      uint64_t haplotype = seg_sites.getHaplotypeWords(j)[0];
+      double height = seg_sites.heights_.at(j);
+      size_t derived = (haplotype & 1) + (haplotype >> 1 & 1) +
+                       (haplotype >> 2 & 1) + (haplotype >> 3 & 1);
+      CPPUNIT_ASSERT_EQUAL( derived, seg_sites.getDerivedCount(j) );
+      CPPUNIT_ASSERT( height >= 0.0 );
+
+      if (haplotype == 1 || haplotype == 2) CPPUNIT_ASSERT( height <= 1.0 );
+      else if (haplotype == 4 || haplotype == 8) CPPUNIT_ASSERT( height <= 3.0 );
+      else if (haplotype == 3) CPPUNIT_ASSERT( 1.0 <= height && height <= 10.0 );
+      else if (haplotype == 12) CPPUNIT_ASSERT( 3.0 <= height && height <= 10.0 );
+      else CPPUNIT_ASSERT( false );
+    }
+  }
+
+  void testSegSitesBinaryOutput() {
+    SegSites seg_sites = SegSites();
+    seg_sites.set_binary(true);
+    seg_sites.set_sample_size(4);
+    seg_sites.positions_ = { 0.5, 0.7, 0.8 };
+    seg_sites.haplotypes_ = { 1, 3, 2 };
+
+    std::ostringstream output;
+    OutputBuffer buffer(output);
+    seg_sites.printLocusOutput(buffer);
+    buffer.flush();
+
+    std::string str = output.str();
+    std::string marker = "binary segsites:\n";
+    CPPUNIT_ASSERT_EQUAL( marker, str.substr(0, marker.size()) );
+    CPPUNIT_ASSERT_EQUAL( marker.size() + 6 * 8 + 4 * 8, str.size() );
+
+    std::vector<uint64_t> header(3);
+    memcpy(header.data(), str.data() + marker.size(), 3 * 8);
+    CPPUNIT_ASSERT_EQUAL( (uint64_t)3, header[0] );
+    CPPUNIT_ASSERT_EQUAL( (uint64_t)4, header[1] );
+    CPPUNIT_ASSERT_EQUAL( (uint64_t)6, header[2] );
+
+    double position;
+    memcpy(&position, str.data() + marker.size() + 4 * 8, 8);
+    CPPUNIT_ASSERT_EQUAL( 0.7, position );
+
+    // The rows of the samples: 110, 011, 000, 000
+    std::vector<uint64_t> rows(4);
+    memcpy(rows.data(), str.data() + marker.size() + 6 * 8, 4 * 8);
+    CPPUNIT_ASSERT_EQUAL( (uint64_t)3, rows[0] );
+    CPPUNIT_ASSERT_EQUAL( (uint64_t)6, rows[1] );
+    CPPUNIT_ASSERT_EQUAL( (uint64_t)0, rows[2] );
+    CPPUNIT_ASSERT_EQUAL( (uint64_t)0, rows[3] );
+  }
+
   void testSiteFrequencies() {
     forest->createScaledExampleTree();
     forest->writable_model()->setMutationRate(0.0001);
@@ -207,26 +282,27 @@ class TestSummaryStatistics : public CppUnit::TestCase {
     seg_sites->positions_.push_back(0.7);
     seg_sites->positions_.push_back(0.8);
 
-    std::valarray<bool> ht = {1, 0, 0, 0};
-    seg_sites->haplotypes_.push_back(ht); // singleton
-    ht[1] = 1;
-    seg_sites->haplotypes_.push_back(ht); // doubleton
-    ht = 0;
-    ht[1] = 1;
-    seg_sites->haplotypes_.push_back(ht); // singletion
+    seg_sites->set_sample_size(4);
+    seg_sites->haplotypes_.push_back(1); // singleton
+    seg_sites->haplotypes_.push_back(3); // doubleton
+    seg_sites->haplotypes_.push_back(2); // singletion
+    seg_sites->derived_ = {1, 2, 1};
     seg_sites->set_position(forest->next_base());
 
     FrequencySpectrum sfs(seg_sites, forest->model());
     std::ostringstream output;
+    OutputBuffer buffer(output);
 
     // Check values for example segment
     sfs.calculate(*forest);
-    sfs.printLocusOutput(output);
+    sfs.printLocusOutput(buffer);
+    buffer.flush();
     CPPUNIT_ASSERT( output.str().compare("SFS: 2 1 0 \n") == 0 );
 
     // Add another segment
     seg_sites->positions_.push_back(0.9);
-    seg_sites->haplotypes_.push_back(ht);
+    seg_sites->haplotypes_.push_back(2);
+    seg_sites->derived_.push_back(1);
     sfs.calculate(*forest);
     CPPUNIT_ASSERT_EQUAL((size_t)3, sfs.sfs().at(0));
     CPPUNIT_ASSERT_EQUAL((size_t)1, sfs.sfs().at(1));
@@ -241,10 +317,104 @@ class TestSummaryStatistics : public CppUnit::TestCase {
     forest->set_current_base(0.0);
     forest->set_next_base(0.000001);
     sfs.calculate(*forest);
-    sfs.printLocusOutput(output);
+    sfs.printLocusOutput(buffer);
+    buffer.flush();
     CPPUNIT_ASSERT( output.str().compare("SFS: 0 0 0 \n") == 0 );
   }
 
+  void testBranchFrequencySpectrum() {
+    forest->createScaledExampleTree();
+    forest->set_current_base(0.0);
+    forest->set_next_base(10.0);
+
+    BranchFrequencySpectrum bsfs(4);
+    bsfs.calculate(*forest);
+    CPPUNIT_ASSERT( bsfs.bsfs() == std::vector<double>({80.0, 160.0, 0.0}) );
+
+    // Segments are added up
+    forest->set_current_base(5.0);
+    bsfs.calculate(*forest);
+    CPPUNIT_ASSERT( bsfs.bsfs() == std::vector<double>({120.0, 240.0, 0.0}) );
+
+    std::ostringstream output;
+    OutputBuffer buffer(output);
+    bsfs.printLocusOutput(buffer);
+    buffer.flush();
+    CPPUNIT_ASSERT_EQUAL( std::string("BSFS: 120 240 0 \n"), output.str() );
+
+    bsfs.clear();
+    CPPUNIT_ASSERT( bsfs.bsfs() == std::vector<double>({0.0, 0.0, 0.0}) );
+  }
+
+  void testSfsStatistics() {
+    auto sfs = std::make_shared<FrequencySpectrum>(std::make_shared<SegSites>(), forest->model());
+    sfs->sfs_ = {2, 1, 1};
+    NucleotideDiversity pi(sfs);
+    WattersonsTheta theta_w(sfs);
+    TajimasD tajimas_d(sfs);
+    NormalizedSFS normalized_sfs(sfs);
+
+    CPPUNIT_ASSERT_EQUAL( (size_t)4, pi.segsites() );
+    CPPUNIT_ASSERT( areSame(13.0 / 6.0, pi.calcPi()) );
+    CPPUNIT_ASSERT( areSame(24.0 / 11.0, theta_w.calcThetaW()) );
+    CPPUNIT_ASSERT( std::fabs(tajimas_d.calcTajimasD() + 0.0650102494825903) < 1e-12 );
+
+    std::vector<double> values;
+    normalized_sfs.getValues(values);
+    CPPUNIT_ASSERT_EQUAL( (size_t)3, normalized_sfs.size() );
+    CPPUNIT_ASSERT( values == std::vector<double>({0.5, 0.25, 0.25}) );
+
+    std::ostringstream output;
+    OutputBuffer buffer(output);
+    pi.printLocusOutput(buffer);
+    normalized_sfs.printLocusOutput(buffer);
+    buffer.flush();
+    CPPUNIT_ASSERT_EQUAL( std::string("pi: 2.16667\nnSFS: 0.5 0.25 0.25 \n"), output.str() );
+
+    // Undefined without segregating sites
+    sfs->sfs_ = {0, 0, 0};
+    CPPUNIT_ASSERT_EQUAL( 0.0, pi.calcPi() );
+    CPPUNIT_ASSERT( std::isnan(tajimas_d.calcTajimasD()) );
+  }
+
+  void testStatisticsTable() {
+    Model model = Param("6 20 -t 5 -r 5 1000 -oRow -oMeans -oPi -oNSFS").parse();
+    CPPUNIT_ASSERT_EQUAL( (size_t)1, model.countSummaryStatistics() );
+    StatisticsTable* table = dynamic_cast<StatisticsTable*>(model.getSummaryStatistic(0));
+    CPPUNIT_ASSERT( table != NULL );
+    CPPUNIT_ASSERT_EQUAL( (size_t)7, table->names().size() );
+    CPPUNIT_ASSERT_EQUAL( std::string("nSFS_5"), table->names().back() );
+
+    MersenneTwister rg(5);
+    Forest forest2(&model, &rg);
+    std::ostringstream output;
+    OutputBuffer buffer(output);
+    double sum = 0.0, sum_squares = 0.0;
+    for (size_t i = 0; i < model.loci_number(); ++i) {
+      forest2.buildInitialTree();
+      while (forest2.next_base() < model.loci_length()) forest2.sampleNextGenealogy();
+      CPPUNIT_ASSERT_EQUAL( (size_t)7, table->values().size() );
+      sum += table->values().at(0);
+      sum_squares += table->values().at(0) * table->values().at(0);
+      forest2.printLocusSumStats(buffer);
+      forest2.clear();
+    }
+    buffer.flush();
+
+    // One row per locus, and the mean and variance of the segregating sites
+    std::string rows = output.str();
+    CPPUNIT_ASSERT_EQUAL( (long)model.loci_number(), (long)std::count(rows.begin(), rows.end(), '\n') );
+    CPPUNIT_ASSERT_EQUAL( model.loci_number(), table->counts().at(0) );
+    CPPUNIT_ASSERT( std::fabs(sum / 20 - table->means().at(0)) < 1e-9 );
+    CPPUNIT_ASSERT( std::fabs((sum_squares - sum * sum / 20) / 19 - table->variances().at(0)) < 1e-9 );
+
+    // Copies own their frequency spectrum
+    StatisticsTable* copy = table->clone();
+    CPPUNIT_ASSERT( copy->names() == table->names() );
+    CPPUNIT_ASSERT( copy->means() == table->means() );
+    delete copy;
+  }
+
   void testOrientedForestGenerateTreeData() {
     OrientedForest of(4);
     size_t pos = 2*forest->sample_size()-2;
@@ -280,8 +450,10 @@ class TestSummaryStatistics : public CppUnit::TestCase {
 
     OrientedForest of(4);
     std::ostringstream output;
+    OutputBuffer buffer(output);
     of.calculate(*forest);
-    of.printSegmentOutput(output);
+    of.printSegmentOutput(buffer);
+    buffer.flush();
     //std::cout << output.str() << std::endl;
     CPPUNIT_ASSERT( output.str().compare("{\"parents\":[5,5,6,6,7,7,0], \"node_times\":[0,0,0,0,1,3,10]}\n") == 0 ||
                     output.str().compare("{\"parents\":[6,6,5,5,7,7,0], \"node_times\":[0,0,0,0,3,1,10]}\n") == 0 );
@@ -291,12 +463,160 @@ class TestSummaryStatistics : public CppUnit::TestCase {
     forest->writable_model()->setRecombinationRate(0.0001);
     of.clear();
     of.calculate(*forest);
-    of.printSegmentOutput(output);
+    of.printSegmentOutput(buffer);
+    buffer.flush();
     //std::cout << output.str() << std::endl;
     CPPUNIT_ASSERT( output.str().compare("{\"length\":10, \"parents\":[5,5,6,6,7,7,0], \"node_times\":[0,0,0,0,1,3,10]}\n") == 0 ||
                     output.str().compare("{\"length\":10, \"parents\":[6,6,5,5,7,7,0], \"node_times\":[0,0,0,0,3,1,10]}\n") == 0 );
   }
 
+  void testTreeSequence() {
+    forest->createScaledExampleTree();
+    forest->set_current_base(0.0);
+    forest->set_next_base(10.0);
+
+    TreeSequence ts;
+    ts.calculate(*forest);
+    CPPUNIT_ASSERT_EQUAL( (size_t)7, ts.node_times().size() );
+    CPPUNIT_ASSERT_EQUAL( 0.0, ts.node_times().at(3) );
+    CPPUNIT_ASSERT_EQUAL( 10.0, ts.node_times().at(4) );
+
+    // Positions are relative to the locus length as for the segregating sites
+    std::vector<TreeSequence::Edge> edges = ts.edges();
+    CPPUNIT_ASSERT_EQUAL( (size_t)6, edges.size() );
+    double length = 0.0;
+    for (const TreeSequence::Edge &edge : edges) {
+      CPPUNIT_ASSERT_EQUAL( 0.0, edge.left );
+      CPPUNIT_ASSERT_EQUAL( 10.0 / forest->model().loci_length(), edge.right );
+      length += ts.node_times().at(edge.parent) - ts.node_times().at(edge.child);
+    }
+    CPPUNIT_ASSERT_EQUAL( 24.0, length );
+
+    std::ostringstream output;
+    OutputBuffer buffer(output);
+    ts.printLocusOutput(buffer);
+    buffer.flush();
+    CPPUNIT_ASSERT( output.str().find("nodes: 7\nid\tis_sample\ttime\n0\t1\t0\n") == 0 );
+    CPPUNIT_ASSERT( output.str().find("edges: 6\nleft\tright\tparent\tchild\n0\t") != std::string::npos );
+
+    // With absolute scaling, the positions are the bases of the locus
+    forest->writable_model()->setSequenceScaling(absolute);
+    ts.clear();
+    ts.calculate(*forest);
+    for (const TreeSequence::Edge &edge : ts.edges()) {
+      CPPUNIT_ASSERT_EQUAL( 0.0, edge.left );
+      CPPUNIT_ASSERT_EQUAL( 10.0, edge.right );
+    }
+    forest->writable_model()->setSequenceScaling(ms);
+
+    ts.clear();
+    CPPUNIT_ASSERT_EQUAL( (size_t)0, ts.node_times().size() );
+    CPPUNIT_ASSERT_EQUAL( (size_t)0, ts.edges().size() );
+  }
+
+  // Collects the branches of the local tree as pairs of the parent and child heights
+  void collectBranches(Node const* node, const double scaling_factor,
+                       std::vector<std::pair<double, double>> &branches) {
+    if (node->in_sample()) return;
+    Node const* children[2] = { node->getLocalChild1(), node->getLocalChild2() };
+    for (Node const* child : children) {
+      branches.push_back(std::make_pair(node->height() * scaling_factor, 
+                                        child->height() * scaling_factor));
+      collectBranches(child, scaling_factor, branches);
+    }
+  }
+
+  void testTreeSequenceWithRecombination() {
+    // Check that the edges reproduce every local tree
+    Model model = Param("6 1 -r 20 1000 -l 50").parse();
+    MersenneTwister rg(77);
+    Forest forest2(&model, &rg);
+
+    TreeSequence ts;
+    std::vector<double> segment_ends;
+    std::vector<std::vector<std::pair<double, double>>> trees;
+    forest2.buildInitialTree();
+    while (true) {
+      ts.calculate(forest2);
+      CPPUNIT_ASSERT( ts.checkEdges(forest2) );
+      if (forest2.next_base() > forest2.current_base()) {
+        std::vector<std::pair<double, double>> branches;
+        collectBranches(forest2.local_root(), model.scaling_factor(), branches);
+        std::sort(branches.begin(), branches.end());
+        trees.push_back(branches);
+        segment_ends.push_back(forest2.next_base() / model.loci_length());
+      }
+      if (forest2.next_base() >= model.loci_length()) break;
+      forest2.sampleNextGenealogy();
+    }
+    CPPUNIT_ASSERT( trees.size() > 5 );
+
+    std::vector<TreeSequence::Edge> edges = ts.edges();
+    CPPUNIT_ASSERT( edges.size() < trees.size() * 10 );
+    for (size_t i = 1; i < edges.size(); ++i) {
+      CPPUNIT_ASSERT( ts.node_times().at(edges[i-1].parent) <= ts.node_times().at(edges[i].parent) );
+    }
+    double left = 0.0;
+    for (size_t i = 0; i < trees.size(); ++i) {
+      std::vector<std::pair<double, double>> branches;
+      for (const TreeSequence::Edge &edge : edges) {
+        if (edge.left <= left && left < edge.right) {
+          branches.push_back(std::make_pair(ts.node_times().at(edge.parent), 
+                                            ts.node_times().at(edge.child)));
+        }
+      }
+      std::sort(branches.begin(), branches.end());
+      CPPUNIT_ASSERT( branches == trees[i] );
+      left = segment_ends[i];
+    }
+  }
+
+  void testOrientedForestIncremental() {
+    Model model = Param("6 1 -r 20 1000 -Odiff").parse();
+    OrientedForest* of = dynamic_cast<OrientedForest*>(model.getSummaryStatistic(0));
+    CPPUNIT_ASSERT( of != NULL && of->incremental() );
+    MersenneTwister rg(78);
+    Forest forest2(&model, &rg);
+
+    // Applying the changes to the previous arrays gives the arrays of each segment
+    std::ostringstream output;
+    OutputBuffer buffer(output);
+    forest2.buildInitialTree();
+    std::vector<int> parents = of->parents();
+    std::vector<double> heights = of->heights();
+    CPPUNIT_ASSERT_EQUAL( (size_t)11, of->changed().size() );
+    size_t changes = 0, segments = 0;
+    while (forest2.next_base() < model.loci_length()) {
+      forest2.sampleNextGenealogy();
+      if (forest2.calcSegmentLength() == 0.0) continue;
+      for (size_t pos : of->changed()) {
+        parents[pos] = of->parents()[pos];
+        heights[pos] = of->heights()[pos];
+      }
+      CPPUNIT_ASSERT( parents == of->parents() );
+      CPPUNIT_ASSERT( heights == of->heights() );
+      changes += of->changed().size();
+      ++segments;
+    }
+    CPPUNIT_ASSERT( segments > 5 );
+    CPPUNIT_ASSERT( changes < segments * 6 );
+
+    // Check the output format
+    of->printSegmentOutput(buffer);
+    buffer.flush();
+    CPPUNIT_ASSERT( output.str().find("\"changed\":[") != std::string::npos );
+    CPPUNIT_ASSERT( output.str().find("\"parents\":[") != std::string::npos );
+
+    // Full output after clearing
+    of->clear();
+    forest2.clear();
+    forest2.buildInitialTree();
+    output.str("");
+    of->printSegmentOutput(buffer);
+    buffer.flush();
+    CPPUNIT_ASSERT( output.str().find("\"changed\"") == std::string::npos );
+  }
+
   void testNewickTree() {
     forest->createScaledExampleTree();
     forest->set_current_base(0.0);
@@ -304,8 +624,10 @@ class TestSummaryStatistics : public CppUnit::TestCase {
 
     NewickTree of(4, forest->model().has_recombination());
     std::ostringstream output;
+    OutputBuffer buffer(output);
     of.calculate(*forest);
-    of.printSegmentOutput(output);
+    of.printSegmentOutput(buffer);
+    buffer.flush();
     //std::cout << output.str() << std::endl;
     CPPUNIT_ASSERT( output.str().compare("((1:1,2:1):9,(3:3,4:3):7);\n") == 0 );
 
@@ -314,7 +636,8 @@ class TestSummaryStatistics : public CppUnit::TestCase {
     forest->writable_model()->setRecombinationRate(0.0001);
     of = NewickTree(4, forest->model().has_recombination());
     of.calculate(*forest);
-    of.printSegmentOutput(output);
+    of.printSegmentOutput(buffer);
+    buffer.flush();
     //std::cout << output.str() << std::endl;
     CPPUNIT_ASSERT( output.str().compare("[10]((1:1,2:1):9,(3:3,4:3):7);\n") == 0 );
 
@@ -325,7 +648,8 @@ class TestSummaryStatistics : public CppUnit::TestCase {
     forest->set_current_base(0.0);
     forest->set_next_base(10000000.0);
     of.calculate(*forest);
-    of.printSegmentOutput(output);
+    of.printSegmentOutput(buffer);
+    buffer.flush();
     //std::cout << output.str() << std::endl;
     CPPUNIT_ASSERT( output.str().compare("[10000000]((1:1,2:1):9,(3:3,4:3):7);\n") == 0 );
 
@@ -338,7 +662,8 @@ class TestSummaryStatistics : public CppUnit::TestCase {
     output.str("");
     output.clear();
     of.calculate(*forest);
-    of.printSegmentOutput(output);
+    of.printSegmentOutput(buffer);
+    buffer.flush();
     //std::cout << output.str() << std::endl;
     CPPUNIT_ASSERT( output.str().compare("[0.01]((1:1,2:1):9,(3:3,4:3):7);\n") == 0 );
   }
@@ -0,0 +1,124 @@
+/*
+ * scrm is an implementation of the Sequential-Coalescent-with-Recombination Model.
+ *
+ * Copyright (C) 2013, 2014 Paul R. Staab, Sha (Joe) Zhu, Dirk Metzler and Gerton Lunter
+ *
+ * This file is part of scrm.
+ *
+ * scrm is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+*/
+
+/*
+ * scrm_bin2ms.cc
+ *
+ * Converts the output of 'scrm ... -o bin' back into the text format of ms,
+ * as scrm prints it without '-o bin'. The binary format is described in
+ * src/summary_statistics/seg_sites.h. All other lines are copied as they are,
+ * except for the '-o bin' option, which is removed from the command line in
+ * the first line.
+ *
+ * Usage: scrm_bin2ms [FILE]
+ * Reads from standard input if no file is given.
+ */
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "../src/output_buffer.h"
+
+void read(std::istream &input, void* data, const size_t length) {
+  input.read(static_cast<char*>(data), length);
+  if ((size_t)input.gcount() != length) throw std::runtime_error("Unexpected end of binary segsites.");
+}
+
+// Removes the '-o bin' option from scrm's command line.
+std::string removeBinaryOption(const std::string &line) {
+  std::istringstream iss(line);
+  std::vector<std::string> args;
+  std::string arg, result;
+  while (iss >> arg) {
+    if (arg == "bin" && !args.empty() && (args.back() == "-o" || args.back() == "--o")) {
+      args.pop_back();
+    } else { 
+      args.push_back(arg);
+    }
+  }
+  for (const std::string &arg : args) result += (result.empty() ? "" : " ") + arg;
+  return result;
+}
+
+void convertSegSites(std::istream &input, OutputBuffer &output) {
+  uint64_t header[3];
+  read(input, header, sizeof(header));
+  const size_t segsites = header[0], samples = header[1];
+  output.set_precision(header[2]);
+
+  output << "segsites: " << segsites << '\n';
+  if (segsites == 0) return;
+
+  std::vector<double> positions(segsites);
+  read(input, positions.data(), segsites * sizeof(double));
+  output << "positions: " << positions << '\n';
+
+  const size_t row_words = (segsites + 63) / 64;
+  std::vector<uint64_t> row(row_words);
+  std::string line(segsites, '0');
+  for (size_t i = 0; i < samples; ++i) {
+    read(input, row.data(), row_words * sizeof(uint64_t));
+    for (size_t j = 0; j < segsites; ++j) line[j] = '0' + ((row[j / 64] >> (j % 64)) & 1);
+    output << line << '\n';
+  }
+}
+
+int main(int argc, char *argv[]) {
+  try {
+    std::ifstream file;
+    if (argc > 2) throw std::invalid_argument("Usage: scrm_bin2ms [FILE]");
+    if (argc == 2) {
+      file.open(argv[1], std::ios::binary);
+      if (!file) throw std::invalid_argument(std::string("Failed to open ") + argv[1]);
+    }
+    std::istream &input = (argc == 2) ? file : std::cin;
+    OutputBuffer output(std::cout);
+
+    std::string line;
+    bool first_line = true;
+    while (std::getline(input, line)) {
+      if (first_line) {
+        output << removeBinaryOption(line) << '\n';
+        first_line = false;
+      } else if (line == "binary segsites:") {
+        convertSegSites(input, output);
+      } else {
+        output << line;
+        if (!input.eof()) output << '\n';
+      }
+    }
+    output.flush();
+    return EXIT_SUCCESS;
+  }
+
+  catch (const std::exception &e) {
+    std::cerr << "Error: " << e.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+}